@@ -0,0 +1,394 @@
+#include "aggregationkernels.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define AGGREGATION_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace AggregationKernels
+{
+
+namespace {
+
+using SumByTypeFunction = TypeTotals (*)(const qint64 *, const quint8 *, qsizetype);
+using SumByKeyFunction = void (*)(const qint64 *, const quint8 *, const qint32 *, qsizetype,
+                                  qint64 *, qint64 *);
+
+// Scalar: the sign and the type become all-ones/all-zero masks, so the loop
+// has no data-dependent branches
+
+inline qint64 absolute(qint64 value)
+{
+    qint64 sign = value >> 63;
+    return (value ^ sign) - sign;
+}
+
+TypeTotals sumByTypeScalar(const qint64 *cents, const quint8 *types, qsizetype count)
+{
+    TypeTotals totals;
+    for (qsizetype i = 0; i < count; ++i) {
+        qint64 amount = absolute(cents[i]);
+        qint64 expense = -qint64(types[i] != 0);
+        totals.expenseCents += amount & expense;
+        totals.incomeCents += amount & ~expense;
+        totals.expenseCount -= expense;
+    }
+    totals.incomeCount = count - totals.expenseCount;
+    return totals;
+}
+
+void sumByKeyScalar(const qint64 *cents, const quint8 *types, const qint32 *keys, qsizetype count,
+                    qint64 *totals, qint64 *counts)
+{
+    // The type picks the slot, so there is nothing to mask
+    for (qsizetype i = 0; i < count; ++i) {
+        qsizetype slot = qsizetype(keys[i]) * 2 + types[i];
+        totals[slot] += absolute(cents[i]);
+        ++counts[slot];
+    }
+}
+
+#ifdef AGGREGATION_KERNELS_X86
+
+// SSE2 has 64-bit add/sub but no 64-bit compare or shift-right-arithmetic,
+// so masks are built from the 32-bit halves
+
+inline __m128i signMask64(__m128i values)
+{
+    __m128i high = _mm_srai_epi32(values, 31);
+    return _mm_shuffle_epi32(high, _MM_SHUFFLE(3, 3, 1, 1));
+}
+
+// Two type bytes widened to two 64-bit lanes of all-ones where they equal type
+inline __m128i typeMask64(const quint8 *types, __m128i type)
+{
+    quint16 pair;
+    std::memcpy(&pair, types, sizeof(pair));
+    __m128i bytes = _mm_cvtsi32_si128(pair);
+    __m128i zero = _mm_setzero_si128();
+    __m128i words = _mm_unpacklo_epi8(bytes, zero);
+    __m128i dwords = _mm_unpacklo_epi16(words, zero);
+    __m128i qwords = _mm_unpacklo_epi32(dwords, zero);
+    __m128i equal = _mm_cmpeq_epi32(qwords, type);
+    // Both halves of a lane must match; the high half is always zero == zero
+    return _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+TypeTotals sumByTypeSse2(const qint64 *cents, const quint8 *types, qsizetype count)
+{
+    const __m128i expenseType = _mm_set_epi32(0, 1, 0, 1);
+    __m128i expenseSum = _mm_setzero_si128();
+    __m128i incomeSum = _mm_setzero_si128();
+    __m128i expenseCount = _mm_setzero_si128();
+
+    qsizetype i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cents + i));
+        __m128i sign = signMask64(values);
+        __m128i amount = _mm_sub_epi64(_mm_xor_si128(values, sign), sign);
+        __m128i expense = typeMask64(types + i, expenseType);
+        expenseSum = _mm_add_epi64(expenseSum, _mm_and_si128(amount, expense));
+        incomeSum = _mm_add_epi64(incomeSum, _mm_andnot_si128(expense, amount));
+        expenseCount = _mm_sub_epi64(expenseCount, expense);
+    }
+
+    alignas(16) qint64 lanes[2];
+    TypeTotals totals;
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes), expenseSum);
+    totals.expenseCents = lanes[0] + lanes[1];
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes), incomeSum);
+    totals.incomeCents = lanes[0] + lanes[1];
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes), expenseCount);
+    totals.expenseCount = lanes[0] + lanes[1];
+
+    TypeTotals tail = sumByTypeScalar(cents + i, types + i, count - i);
+    totals.expenseCents += tail.expenseCents;
+    totals.incomeCents += tail.incomeCents;
+    totals.expenseCount += tail.expenseCount;
+    totals.incomeCount = count - totals.expenseCount;
+    return totals;
+}
+
+inline qint64 horizontalSum(__m128i values)
+{
+    alignas(16) qint64 lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes), values);
+    return lanes[0] + lanes[1];
+}
+
+// Adds the register sums of a run of rows with the same key to its slots
+inline void flushRunSse2(qint32 key, qint64 rows, __m128i& incomeSum, __m128i& expenseSum,
+                         __m128i& expenseCount, qint64 *totals, qint64 *counts)
+{
+    if (rows == 0)
+        return;
+    qsizetype slot = qsizetype(key) * 2;
+    qint64 expenses = horizontalSum(expenseCount);
+    totals[slot] += horizontalSum(incomeSum);
+    totals[slot + 1] += horizontalSum(expenseSum);
+    counts[slot] += rows - expenses;
+    counts[slot + 1] += expenses;
+    incomeSum = expenseSum = expenseCount = _mm_setzero_si128();
+}
+
+void sumByKeySse2(const qint64 *cents, const quint8 *types, const qint32 *keys, qsizetype count,
+                  qint64 *totals, qint64 *counts)
+{
+    // Keys come from time-sorted rows, so they mostly arrive in long runs.
+    // A block of four rows that stays on the current key is summed in
+    // registers; the run is flushed to the arrays when the key changes and
+    // the breaking block is scattered one row at a time.
+    const __m128i expenseType = _mm_set_epi32(0, 1, 0, 1);
+    __m128i expenseSum = _mm_setzero_si128();
+    __m128i incomeSum = _mm_setzero_si128();
+    __m128i expenseCount = _mm_setzero_si128();
+    qint64 runRows = 0;
+    qint32 runKey = count > 0 ? keys[0] : 0;
+
+    qsizetype i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i blockKeys = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+        __m128i sameKey = _mm_cmpeq_epi32(blockKeys, _mm_set1_epi32(runKey));
+        if (_mm_movemask_ps(_mm_castsi128_ps(sameKey)) != 0xF) {
+            flushRunSse2(runKey, runRows, incomeSum, expenseSum, expenseCount, totals, counts);
+            runRows = 0;
+            sumByKeyScalar(cents + i, types + i, keys + i, 4, totals, counts);
+            runKey = keys[i + 3];
+            continue;
+        }
+        for (int half = 0; half < 4; half += 2) {
+            __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cents + i + half));
+            __m128i sign = signMask64(values);
+            __m128i amount = _mm_sub_epi64(_mm_xor_si128(values, sign), sign);
+            __m128i expense = typeMask64(types + i + half, expenseType);
+            expenseSum = _mm_add_epi64(expenseSum, _mm_and_si128(amount, expense));
+            incomeSum = _mm_add_epi64(incomeSum, _mm_andnot_si128(expense, amount));
+            expenseCount = _mm_sub_epi64(expenseCount, expense);
+        }
+        runRows += 4;
+    }
+    flushRunSse2(runKey, runRows, incomeSum, expenseSum, expenseCount, totals, counts);
+    sumByKeyScalar(cents + i, types + i, keys + i, count - i, totals, counts);
+}
+
+AVX2_TARGET TypeTotals sumByTypeAvx2(const qint64 *cents, const quint8 *types, qsizetype count)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i expenseType = _mm256_set1_epi64x(1);
+    __m256i expenseSum = zero;
+    __m256i incomeSum = zero;
+    __m256i expenseCount = zero;
+
+    qsizetype i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cents + i));
+        __m256i sign = _mm256_cmpgt_epi64(zero, values);
+        __m256i amount = _mm256_sub_epi64(_mm256_xor_si256(values, sign), sign);
+
+        qint32 quad;
+        std::memcpy(&quad, types + i, sizeof(quad));
+        __m256i typeLanes = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(quad));
+        __m256i expense = _mm256_cmpeq_epi64(typeLanes, expenseType);
+
+        expenseSum = _mm256_add_epi64(expenseSum, _mm256_and_si256(amount, expense));
+        incomeSum = _mm256_add_epi64(incomeSum, _mm256_andnot_si256(expense, amount));
+        expenseCount = _mm256_sub_epi64(expenseCount, expense);
+    }
+
+    alignas(32) qint64 lanes[4];
+    TypeTotals totals;
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), expenseSum);
+    totals.expenseCents = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), incomeSum);
+    totals.incomeCents = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), expenseCount);
+    totals.expenseCount = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+    TypeTotals tail = sumByTypeScalar(cents + i, types + i, count - i);
+    totals.expenseCents += tail.expenseCents;
+    totals.incomeCents += tail.incomeCents;
+    totals.expenseCount += tail.expenseCount;
+    totals.incomeCount = count - totals.expenseCount;
+    return totals;
+}
+
+AVX2_TARGET inline qint64 horizontalSum(__m256i values)
+{
+    alignas(32) qint64 lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), values);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+AVX2_TARGET inline void flushRunAvx2(qint32 key, qint64 rows, __m256i& incomeSum, __m256i& expenseSum,
+                                     __m256i& expenseCount, qint64 *totals, qint64 *counts)
+{
+    if (rows == 0)
+        return;
+    qsizetype slot = qsizetype(key) * 2;
+    qint64 expenses = horizontalSum(expenseCount);
+    totals[slot] += horizontalSum(incomeSum);
+    totals[slot + 1] += horizontalSum(expenseSum);
+    counts[slot] += rows - expenses;
+    counts[slot + 1] += expenses;
+    incomeSum = expenseSum = expenseCount = _mm256_setzero_si256();
+}
+
+AVX2_TARGET void sumByKeyAvx2(const qint64 *cents, const quint8 *types, const qint32 *keys, qsizetype count,
+                              qint64 *totals, qint64 *counts)
+{
+    // Same run-based scheme as the SSE2 version, four rows per register.
+    // AVX2 can gather but not scatter, so rows that break a run still take
+    // the scalar path.
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i expenseType = _mm256_set1_epi64x(1);
+    __m256i expenseSum = zero;
+    __m256i incomeSum = zero;
+    __m256i expenseCount = zero;
+    qint64 runRows = 0;
+    qint32 runKey = count > 0 ? keys[0] : 0;
+
+    qsizetype i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i blockKeys = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i));
+        __m128i sameKey = _mm_cmpeq_epi32(blockKeys, _mm_set1_epi32(runKey));
+        if (_mm_movemask_ps(_mm_castsi128_ps(sameKey)) != 0xF) {
+            flushRunAvx2(runKey, runRows, incomeSum, expenseSum, expenseCount, totals, counts);
+            runRows = 0;
+            sumByKeyScalar(cents + i, types + i, keys + i, 4, totals, counts);
+            runKey = keys[i + 3];
+            continue;
+        }
+
+        __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cents + i));
+        __m256i sign = _mm256_cmpgt_epi64(zero, values);
+        __m256i amount = _mm256_sub_epi64(_mm256_xor_si256(values, sign), sign);
+
+        qint32 quad;
+        std::memcpy(&quad, types + i, sizeof(quad));
+        __m256i typeLanes = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(quad));
+        __m256i expense = _mm256_cmpeq_epi64(typeLanes, expenseType);
+
+        expenseSum = _mm256_add_epi64(expenseSum, _mm256_and_si256(amount, expense));
+        incomeSum = _mm256_add_epi64(incomeSum, _mm256_andnot_si256(expense, amount));
+        expenseCount = _mm256_sub_epi64(expenseCount, expense);
+        runRows += 4;
+    }
+    flushRunAvx2(runKey, runRows, incomeSum, expenseSum, expenseCount, totals, counts);
+    sumByKeyScalar(cents + i, types + i, keys + i, count - i, totals, counts);
+}
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuidex(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    // The OS must save the YMM registers on context switches
+    return avx2 && osxsave && (_xgetbv(0) & 0x6) == 0x6;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // AGGREGATION_KERNELS_X86
+
+struct Dispatch {
+    Path path;
+    SumByTypeFunction sumByType;
+    SumByKeyFunction sumByKey;
+};
+
+Dispatch dispatchFor(Path path)
+{
+#ifdef AGGREGATION_KERNELS_X86
+    if (path == Path::Avx2)
+        return {Path::Avx2, sumByTypeAvx2, sumByKeyAvx2};
+    if (path == Path::Sse2)
+        return {Path::Sse2, sumByTypeSse2, sumByKeySse2};
+#endif
+    return {Path::Scalar, sumByTypeScalar, sumByKeyScalar};
+}
+
+Dispatch& dispatch()
+{
+    static Dispatch current = dispatchFor(isSupported(Path::Avx2) ? Path::Avx2
+                                          : isSupported(Path::Sse2) ? Path::Sse2
+                                                                    : Path::Scalar);
+    return current;
+}
+
+}
+
+bool isSupported(Path path)
+{
+    switch (path) {
+    case Path::Scalar:
+        return true;
+#ifdef AGGREGATION_KERNELS_X86
+    case Path::Sse2:
+        // Part of the x86-64 baseline; 32-bit builds need it enabled
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        return true;
+#else
+        return false;
+#endif
+    case Path::Avx2: {
+        static const bool avx2 = cpuHasAvx2();
+        return avx2;
+    }
+#else
+    default:
+        return false;
+#endif
+    }
+    return false;
+}
+
+Path activePath()
+{
+    return dispatch().path;
+}
+
+const char *pathName(Path path)
+{
+    switch (path) {
+    case Path::Scalar: return "scalar";
+    case Path::Sse2:   return "SSE2";
+    case Path::Avx2:   return "AVX2";
+    }
+    return "unknown";
+}
+
+bool setPath(Path path)
+{
+    if (!isSupported(path))
+        return false;
+    dispatch() = dispatchFor(path);
+    return true;
+}
+
+TypeTotals sumByType(const qint64 *cents, const quint8 *types, qsizetype count)
+{
+    return dispatch().sumByType(cents, types, count);
+}
+
+void sumByKey(const qint64 *cents, const quint8 *types, const qint32 *keys, qsizetype count,
+              qint64 *totals, qint64 *counts)
+{
+    dispatch().sumByKey(cents, types, keys, count, totals, counts);
+}
+
+}
@@ -0,0 +1,344 @@
+#include "analyticsstore.h"
+#include "aggregationkernels.h"
+#include "databasemanager.h"
+#include <QThreadPool>
+#include <QVector>
+#include <QtConcurrent/QtConcurrentMap>
+
+void AnalyticsStore::clear()
+{
+    categories.clear();
+    months = Buckets();
+    days = Buckets();
+    balanceSteps.clear();
+    balance = Money();
+    markBalanceChanged(std::numeric_limits<qint64>::min());
+}
+
+void AnalyticsStore::loadSummary(const QVector<TransactionSummary>& summary)
+{
+    for (const TransactionSummary& row : summary) {
+        if (row.type == Transaction::Expense) {
+            CategoryTotal& total = categories[row.categoryId];
+            total.amount += row.total;
+            total.count += row.count;
+        }
+
+        months.reserve(row.monthKey, row.monthKey);
+        PeriodTotal& month = months.at(row.monthKey);
+        if (row.type == Transaction::Income)
+            month.income += row.total;
+        else
+            month.expenses += row.total;
+        month.count += row.count;
+    }
+}
+
+void AnalyticsStore::addTransaction(const Transaction& transaction)
+{
+    apply(transaction, 1);
+}
+
+void AnalyticsStore::removeTransaction(const Transaction& transaction)
+{
+    apply(transaction, -1);
+}
+
+// Rows handed to one pool task; smaller chunks are aggregated inline
+static const int minRowsPerTask = 32768;
+
+struct AnalyticsStore::Partial {
+    // Income/expenses per day from firstDay on
+    qint64 firstDay = 0;
+    QVector<PeriodTotal> days;
+    // One entry per run of equal timestamps, in row order
+    QVector<qint64> stepTimes;
+    QVector<BalanceStep> steps;
+};
+
+void AnalyticsStore::addTransactions(const TransactionStore& store, int first, int count)
+{
+    if (count <= 0)
+        return;
+
+    int tasks = qMin(QThreadPool::globalInstance()->maxThreadCount(), count / minRowsPerTask);
+    if (tasks <= 1) {
+        merge(aggregate(store, first, count));
+        return;
+    }
+
+    QVector<QPair<int, int>> ranges;
+    ranges.reserve(tasks);
+    for (int task = 0; task < tasks; ++task) {
+        int begin = first + int(qint64(count) * task / tasks);
+        int end = first + int(qint64(count) * (task + 1) / tasks);
+        ranges.append(qMakePair(begin, end - begin));
+    }
+
+    // Map on the pool, then merge on this thread in range order
+    const QList<Partial> partials = QtConcurrent::blockingMapped<QList<Partial>>(
+        ranges, [&store](const QPair<int, int>& range) {
+            return aggregate(store, range.first, range.second);
+        });
+    for (const Partial& partial : partials)
+        merge(partial);
+}
+
+AnalyticsStore::Partial AnalyticsStore::aggregate(const TransactionStore& store, int first, int count)
+{
+    const qint64 *timestamps = store.timestamps().constData() + first;
+    const qint64 *amounts = store.amounts().constData() + first;
+    const quint8 *types = store.types().constData() + first;
+
+    Partial partial;
+
+    // Rows are bucketed by local day. They arrive in time order, so the day
+    // bounds are only recomputed when a row falls outside the previous day.
+    QVector<qint32> dayKeys(count);
+    DayKeyCache dayCache;
+    qint64 minDay = 0;
+    qint64 maxDay = 0;
+    for (int i = 0; i < count; ++i) {
+        qint64 timestamp = timestamps[i];
+        qint64 day = dayCache.dayOf(timestamp);
+        dayKeys[i] = qint32(day);
+        if (i == 0 || day < minDay)
+            minDay = day;
+        if (i == 0 || day > maxDay)
+            maxDay = day;
+
+        qint64 delta = amounts[i] < 0 ? -amounts[i] : amounts[i];
+        if (types[i] != Transaction::Income)
+            delta = -delta;
+        if (partial.stepTimes.isEmpty() || partial.stepTimes.constLast() != timestamp) {
+            partial.stepTimes.append(timestamp);
+            partial.steps.append(BalanceStep());
+        }
+        BalanceStep& step = partial.steps.last();
+        step.delta += Money::fromCents(delta);
+        ++step.count;
+    }
+    for (int i = 0; i < count; ++i)
+        dayKeys[i] -= qint32(minDay);
+
+    // The rollup kernel fills slot key * 2 + type, so odd slots hold expenses
+    int dayCount = int(maxDay - minDay + 1);
+    QVector<qint64> dayCents(dayCount * 2);
+    QVector<qint64> dayCounts(dayCount * 2);
+    AggregationKernels::sumByKey(amounts, types, dayKeys.constData(), count,
+                                 dayCents.data(), dayCounts.data());
+
+    partial.firstDay = minDay;
+    partial.days.resize(dayCount);
+    for (int key = 0; key < dayCount; ++key) {
+        PeriodTotal& total = partial.days[key];
+        total.income = Money::fromCents(dayCents[key * 2 + Transaction::Income]);
+        total.expenses = Money::fromCents(dayCents[key * 2 + Transaction::Expense]);
+        total.count = int(dayCounts[key * 2] + dayCounts[key * 2 + 1]);
+    }
+    return partial;
+}
+
+void AnalyticsStore::merge(const Partial& partial)
+{
+    if (!partial.days.isEmpty()) {
+        days.reserve(partial.firstDay, partial.firstDay + partial.days.size() - 1);
+        PeriodTotal *target = &days.at(partial.firstDay);
+        for (const PeriodTotal& day : partial.days) {
+            target->income += day.income;
+            target->expenses += day.expenses;
+            target->count += day.count;
+            ++target;
+        }
+    }
+
+    // Loaded chunks extend the timeline at one end, so most steps are
+    // inserted with a hint instead of a full lookup
+    for (int i = 0; i < partial.stepTimes.size(); ++i) {
+        qint64 timestamp = partial.stepTimes.at(i);
+        const BalanceStep& step = partial.steps.at(i);
+        balance += step.delta;
+        markBalanceChanged(timestamp);
+        if (balanceSteps.isEmpty() || timestamp < balanceSteps.firstKey()) {
+            balanceSteps.insert(balanceSteps.cbegin(), timestamp, step);
+        } else if (timestamp > balanceSteps.lastKey()) {
+            balanceSteps.insert(balanceSteps.cend(), timestamp, step);
+        } else {
+            BalanceStep& existing = balanceSteps[timestamp];
+            existing.delta += step.delta;
+            existing.count += step.count;
+        }
+    }
+}
+
+void AnalyticsStore::apply(const Transaction& transaction, int direction)
+{
+    Money amount = transaction.amount().abs() * direction;
+    bool income = transaction.type() == Transaction::Income;
+
+    // Per-category expense totals
+    if (!income) {
+        auto it = categories.find(transaction.categoryId());
+        if (it == categories.end())
+            it = categories.insert(transaction.categoryId(), CategoryTotal());
+        it->amount += amount;
+        it->count += direction;
+        if (it->count <= 0)
+            categories.erase(it);
+    }
+
+    // Per-month and per-day income and expenses
+    qint64 day = transaction.datetime().date().toJulianDay();
+    qint64 monthKey = DateBucket::key(DateBucket::Month, day);
+    months.reserve(monthKey, monthKey);
+    days.reserve(day, day);
+    for (PeriodTotal *total : {&months.at(monthKey), &days.at(day)}) {
+        if (income)
+            total->income += amount;
+        else
+            total->expenses += amount;
+        total->count += direction;
+    }
+    if (direction < 0) {
+        months.trim();
+        days.trim();
+    }
+
+    // Net balance change per timestamp
+    qint64 timestamp = transaction.datetime().toMSecsSinceEpoch();
+    auto stepIt = balanceSteps.find(timestamp);
+    if (stepIt == balanceSteps.end())
+        stepIt = balanceSteps.insert(timestamp, BalanceStep());
+    stepIt->delta += income ? amount : -amount;
+    stepIt->count += direction;
+    if (stepIt->count <= 0)
+        balanceSteps.erase(stepIt);
+    balance += income ? amount : -amount;
+    markBalanceChanged(timestamp);
+}
+
+void AnalyticsStore::markBalanceChanged(qint64 timestamp)
+{
+    if (!balanceChanged || timestamp < balanceChangedFrom)
+        balanceChangedFrom = timestamp;
+    balanceChanged = true;
+}
+
+void AnalyticsStore::Buckets::reserve(qint64 from, qint64 to)
+{
+    if (totals.isEmpty()) {
+        first = from;
+        totals.resize(int(to - from + 1));
+        return;
+    }
+    if (from < first) {
+        totals.insert(0, int(first - from), PeriodTotal());
+        first = from;
+    }
+    if (to >= first + totals.size())
+        totals.resize(int(to - first + 1));
+}
+
+void AnalyticsStore::Buckets::trim()
+{
+    int end = totals.size();
+    while (end > 0 && totals.at(end - 1).count <= 0)
+        --end;
+    totals.resize(end);
+
+    int begin = 0;
+    while (begin < totals.size() && totals.at(begin).count <= 0)
+        ++begin;
+    if (begin > 0) {
+        totals.remove(0, begin);
+        first += begin;
+    }
+}
+
+QVector<AnalyticsStore::Period> AnalyticsStore::periodTotals(DateBucket::Granularity granularity) const
+{
+    // Days and weeks roll up the day array, longer periods the month array.
+    // Consecutive buckets map to non-decreasing keys, so the rollup is a
+    // single pass that starts a new period whenever the key changes.
+    bool byDay = granularity == DateBucket::Day || granularity == DateBucket::Week;
+    const Buckets& source = byDay ? days : months;
+
+    QVector<Period> periods;
+    for (int i = 0; i < source.totals.size(); ++i) {
+        const PeriodTotal& total = source.totals.at(i);
+        if (total.count <= 0)
+            continue;
+        qint64 key = byDay ? DateBucket::key(granularity, source.first + i)
+                           : DateBucket::keyFromMonth(granularity, source.first + i);
+        if (periods.isEmpty() || periods.constLast().key != key)
+            periods.append({key, PeriodTotal()});
+        Period& period = periods.last();
+        period.total.income += total.income;
+        period.total.expenses += total.expenses;
+        period.total.count += total.count;
+    }
+    return periods;
+}
+
+bool AnalyticsStore::takeBalanceChanges(qint64 *from, QList<QPointF> *points)
+{
+    if (!balanceChanged)
+        return false;
+    *from = balanceChangedFrom;
+    balanceChanged = false;
+
+    // Steps before the first change keep their running balance, so only the
+    // tail is rescanned. It starts from the total minus the tail's deltas.
+    // The sum stays in cents; only the plotted points are doubles.
+    QVector<qint64> times;
+    QVector<qint64> deltas;
+    qint64 tailSum = 0;
+    for (auto it = balanceSteps.lowerBound(*from); it != balanceSteps.cend(); ++it) {
+        times.append(it.key());
+        deltas.append(it->delta.cents());
+        tailSum += it->delta.cents();
+    }
+
+    // Blocked scan: every block sums its slice in parallel, the block offsets
+    // are scanned serially, then every block writes its points from its offset
+    struct Block {
+        int begin = 0;
+        int end = 0;
+        qint64 sum = 0;
+        qint64 offset = 0;
+    };
+
+    int size = deltas.size();
+    int blockCount = qBound(1, size / minRowsPerTask, QThreadPool::globalInstance()->maxThreadCount());
+    QVector<Block> blocks(blockCount);
+    for (int i = 0; i < blockCount; ++i) {
+        blocks[i].begin = int(qint64(size) * i / blockCount);
+        blocks[i].end = int(qint64(size) * (i + 1) / blockCount);
+    }
+    blocks[0].offset = balance.cents() - tailSum;
+
+    auto sumBlock = [&deltas](Block& block) {
+        for (int i = block.begin; i < block.end; ++i)
+            block.sum += deltas.at(i);
+    };
+
+    points->resize(size);
+    QPointF *output = points->data();
+    auto writeBlock = [&times, &deltas, output](Block& block) {
+        qint64 running = block.offset;
+        for (int i = block.begin; i < block.end; ++i) {
+            running += deltas.at(i);
+            output[i] = QPointF(times.at(i), Money::fromCents(running).toDouble());
+        }
+    };
+
+    if (blockCount == 1) {
+        writeBlock(blocks[0]);
+    } else {
+        QtConcurrent::blockingMap(blocks, sumBlock);
+        for (int i = 1; i < blockCount; ++i)
+            blocks[i].offset = blocks[i - 1].offset + blocks[i - 1].sum;
+        QtConcurrent::blockingMap(blocks, writeBlock);
+    }
+    return true;
+}
@@ -0,0 +1,158 @@
+// Micro-benchmark for the aggregation kernels on synthetic columnar data.
+// Built only with -DMODERNFINANCETRACKER_BUILD_BENCHMARKS=ON.
+
+#include "aggregationkernels.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int CategoryCount = 16;
+constexpr int MonthCount = 120;
+
+// The row shape the per-transaction loops walked before the columnar store
+struct Row {
+    double amount;
+    int type;
+    int category;
+    int month;
+};
+
+template <typename Function>
+double bestOf(int runs, Function function)
+{
+    double best = 0.0;
+    for (int run = 0; run < runs; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (run == 0 || elapsed.count() < best)
+            best = elapsed.count();
+    }
+    return best;
+}
+
+void report(const char *name, qsizetype rows, double seconds, double baseline)
+{
+    std::printf("%-28s %8.2f ms %10.1f Mrows/s %6.2fx\n", name, seconds * 1000.0,
+                rows / seconds / 1e6, baseline / seconds);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    qsizetype rows = argc > 1 ? std::atoll(argv[1]) : 10000000;
+    const int runs = 5;
+
+    std::mt19937_64 random(42);
+    std::uniform_int_distribution<qint64> amountDistribution(1, 500000);
+    std::bernoulli_distribution expenseDistribution(0.7);
+    std::uniform_int_distribution<int> categoryDistribution(0, CategoryCount - 1);
+
+    std::vector<Row> table(rows);
+    std::vector<qint64> cents(rows);
+    std::vector<quint8> types(rows);
+    std::vector<qint32> categories(rows);
+    std::vector<qint32> months(rows);
+    for (qsizetype i = 0; i < rows; ++i) {
+        bool expense = expenseDistribution(random);
+        qint64 amount = amountDistribution(random);
+        cents[i] = expense ? -amount : amount;
+        types[i] = expense ? 1 : 0;
+        categories[i] = categoryDistribution(random);
+        // Sorted by time, like the loaded store
+        months[i] = int(i * MonthCount / rows);
+        table[i] = {cents[i] / 100.0, types[i], categories[i], months[i]};
+    }
+
+    std::printf("%lld rows, best of %d runs, detected path: %s\n\n", static_cast<long long>(rows), runs,
+                AggregationKernels::pathName(AggregationKernels::activePath()));
+
+    // Totals: the old branchy loop over doubles against each kernel path
+    volatile double sink = 0.0;
+    double baseline = bestOf(runs, [&] {
+        double income = 0.0;
+        double expenses = 0.0;
+        for (const Row& row : table) {
+            if (row.type == 0)
+                income += std::abs(row.amount);
+            else
+                expenses += std::abs(row.amount);
+        }
+        sink = income - expenses;
+    });
+    report("totals: per-row loop", rows, baseline, baseline);
+
+    const AggregationKernels::Path paths[] = {AggregationKernels::Path::Scalar,
+                                              AggregationKernels::Path::Sse2,
+                                              AggregationKernels::Path::Avx2};
+    AggregationKernels::TypeTotals reference;
+    for (AggregationKernels::Path path : paths) {
+        if (!AggregationKernels::setPath(path))
+            continue;
+        AggregationKernels::TypeTotals totals;
+        double seconds = bestOf(runs, [&] {
+            totals = AggregationKernels::sumByType(cents.data(), types.data(), rows);
+        });
+        if (path == AggregationKernels::Path::Scalar)
+            reference = totals;
+        else if (totals.incomeCents != reference.incomeCents || totals.expenseCents != reference.expenseCents
+                 || totals.expenseCount != reference.expenseCount)
+            std::printf("MISMATCH in %s totals\n", AggregationKernels::pathName(path));
+        char name[64];
+        std::snprintf(name, sizeof(name), "totals: %s", AggregationKernels::pathName(path));
+        report(name, rows, seconds, baseline);
+    }
+    std::printf("\n");
+
+    // Rollups: expenses by category plus income and expenses by month
+    baseline = bestOf(runs, [&] {
+        std::vector<double> byCategory(CategoryCount);
+        std::vector<double> incomeByMonth(MonthCount);
+        std::vector<double> expensesByMonth(MonthCount);
+        for (const Row& row : table) {
+            if (row.type == 0) {
+                incomeByMonth[row.month] += std::abs(row.amount);
+            } else {
+                byCategory[row.category] += std::abs(row.amount);
+                expensesByMonth[row.month] += std::abs(row.amount);
+            }
+        }
+        sink = byCategory[0] + incomeByMonth[0] + expensesByMonth[0];
+    });
+    report("rollups: per-row loop", rows, baseline, baseline);
+
+    std::vector<qint64> referenceRollups;
+    for (AggregationKernels::Path path : paths) {
+        if (!AggregationKernels::setPath(path))
+            continue;
+        std::vector<qint64> result;
+        double seconds = bestOf(runs, [&] {
+            std::vector<qint64> byCategory(CategoryCount * 2), categoryCounts(CategoryCount * 2);
+            std::vector<qint64> byMonth(MonthCount * 2), monthCounts(MonthCount * 2);
+            AggregationKernels::sumByKey(cents.data(), types.data(), categories.data(), rows,
+                                         byCategory.data(), categoryCounts.data());
+            AggregationKernels::sumByKey(cents.data(), types.data(), months.data(), rows,
+                                         byMonth.data(), monthCounts.data());
+            result = byCategory;
+            result.insert(result.end(), categoryCounts.begin(), categoryCounts.end());
+            result.insert(result.end(), byMonth.begin(), byMonth.end());
+            result.insert(result.end(), monthCounts.begin(), monthCounts.end());
+        });
+        if (path == AggregationKernels::Path::Scalar)
+            referenceRollups = result;
+        else if (result != referenceRollups)
+            std::printf("MISMATCH in %s rollups\n", AggregationKernels::pathName(path));
+        char name[64];
+        std::snprintf(name, sizeof(name), "rollups: %s", AggregationKernels::pathName(path));
+        report(name, rows, seconds, baseline);
+    }
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+// Per-row insert latency with and without the statement cache. All rows of
+// a run go into one SQL transaction, so the time is parse/plan and
+// execution rather than fsync. Built only with
+// -DMODERNFINANCETRACKER_BUILD_BENCHMARKS=ON.
+//
+// usage: ingest_benchmark [rows]
+
+#include "statementcache.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QSqlError>
+#include <QTemporaryDir>
+#include <cstdio>
+#include <functional>
+
+namespace {
+
+const QString insertSql = "INSERT INTO transactions (type, amount_cents, description, category_id, datetime_ms) "
+                          "VALUES (?, ?, ?, ?, ?)";
+
+void bindRow(QSqlQuery& query, int row)
+{
+    query.bindValue(0, row % 3 == 0 ? 0 : 1);
+    query.bindValue(1, qint64(row % 50000) + 1);
+    query.bindValue(2, QString("row %1").arg(row));
+    query.bindValue(3, row % 16 + 1);
+    query.bindValue(4, qint64(row) * 60000);
+}
+
+// Best of three runs, in nanoseconds per row
+double measure(QSqlDatabase& db, int rows, const std::function<bool(int)>& insertRow)
+{
+    double best = 0.0;
+    for (int run = 0; run < 3; ++run) {
+        QSqlQuery(db).exec("DELETE FROM transactions");
+        QElapsedTimer timer;
+        timer.start();
+        db.transaction();
+        for (int row = 0; row < rows; ++row) {
+            if (!insertRow(row)) {
+                db.rollback();
+                return -1.0;
+            }
+        }
+        db.commit();
+        double perRow = double(timer.nsecsElapsed()) / rows;
+        if (run == 0 || perRow < best)
+            best = perRow;
+    }
+    return best;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    int rows = argc > 1 ? qMax(1, QString(argv[1]).toInt()) : 100000;
+
+    QTemporaryDir dir;
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "ingest");
+    db.setDatabaseName(dir.filePath("ingest.db"));
+    if (!dir.isValid() || !db.open()) {
+        std::printf("error: could not open a temporary database\n");
+        return 1;
+    }
+    QSqlQuery(db).exec("PRAGMA journal_mode = WAL");
+    QSqlQuery(db).exec("CREATE TABLE transactions ("
+                       "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                       "type INTEGER NOT NULL,"
+                       "amount_cents INTEGER NOT NULL,"
+                       "description TEXT,"
+                       "category_id INTEGER NOT NULL,"
+                       "datetime_ms INTEGER NOT NULL)");
+    QSqlQuery(db).exec("CREATE INDEX idx_transactions_datetime ON transactions(datetime_ms)");
+
+    // What the single-row insert did before: a new query and prepare() per row
+    double uncached = measure(db, rows, [&db](int row) {
+        QSqlQuery query(db);
+        if (!query.prepare(insertSql))
+            return false;
+        bindRow(query, row);
+        return query.exec();
+    });
+
+    StatementCache statements;
+    statements.setDatabase(db);
+    double cached = measure(db, rows, [&statements](int row) {
+        QSqlQuery *query = statements.prepare(insertSql);
+        if (!query)
+            return false;
+        bindRow(*query, row);
+        return query->exec();
+    });
+
+    if (uncached < 0 || cached < 0) {
+        std::printf("error: insert failed\n");
+        return 1;
+    }
+
+    std::printf("%d rows per run, best of 3\n\n", rows);
+    std::printf("%-22s %10.0f ns/row\n", "prepare per row", uncached);
+    std::printf("%-22s %10.0f ns/row %6.2fx\n", "statement cache", cached, uncached / cached);
+    std::printf("\ncache: %llu hits, %llu misses\n", static_cast<unsigned long long>(statements.hits()),
+                static_cast<unsigned long long>(statements.misses()));
+
+    statements.clear();
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase("ingest");
+    return 0;
+}
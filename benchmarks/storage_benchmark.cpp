@@ -0,0 +1,198 @@
+// Compares the storage profiles on the insert and scan patterns the
+// application uses. Built only with -DMODERNFINANCETRACKER_BUILD_BENCHMARKS=ON.
+//
+// usage: storage_benchmark [rows] [profile...]
+
+#include "storageprofile.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QVariantList>
+#include <cstdio>
+#include <limits>
+#include <random>
+
+namespace {
+
+constexpr int AutocommitRows = 2000;
+constexpr int PageSize = 500;
+constexpr qint64 DayMs = 86400000;
+
+struct Result {
+    double autocommit = 0.0;
+    double batched = 0.0;
+    double aggregate = 0.0;
+    double pages = 0.0;
+};
+
+bool exec(QSqlQuery& query, const QString& sql)
+{
+    if (query.exec(sql))
+        return true;
+    std::printf("error: %s: %s\n", qPrintable(sql), qPrintable(query.lastError().text()));
+    return false;
+}
+
+void fillBatch(std::mt19937_64& random, int rows, qint64 firstTime, QVariantList *types,
+               QVariantList *amounts, QVariantList *categories, QVariantList *times)
+{
+    std::uniform_int_distribution<qint64> amountDistribution(1, 500000);
+    std::bernoulli_distribution expenseDistribution(0.7);
+    std::uniform_int_distribution<int> categoryDistribution(1, 16);
+    for (int i = 0; i < rows; ++i) {
+        bool expense = expenseDistribution(random);
+        *types << (expense ? 1 : 0);
+        *amounts << (expense ? -amountDistribution(random) : amountDistribution(random));
+        *categories << categoryDistribution(random);
+        // A few dozen rows per day, in time order like a real history
+        *times << firstTime + qint64(i) * DayMs / 40;
+    }
+}
+
+bool run(const StorageProfile& profile, const QString& path, int rows, Result *result)
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", profile.name);
+    db.setDatabaseName(path);
+    db.setConnectOptions(profile.connectOptions(false));
+    if (!db.open() || !profile.apply(db, false)) {
+        std::printf("error: could not open %s\n", qPrintable(path));
+        return false;
+    }
+
+    QSqlQuery query(db);
+    if (!exec(query, "CREATE TABLE transactions ("
+                     "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                     "type INTEGER NOT NULL,"
+                     "amount_cents INTEGER NOT NULL,"
+                     "description TEXT,"
+                     "category_id INTEGER NOT NULL,"
+                     "datetime_ms INTEGER NOT NULL)")
+        || !exec(query, "CREATE INDEX idx_transactions_datetime ON transactions(datetime_ms)"))
+        return false;
+
+    std::mt19937_64 random(42);
+    const QString insertSql = "INSERT INTO transactions (type, amount_cents, description, category_id, datetime_ms) "
+                              "VALUES (?, ?, 'benchmark', ?, ?)";
+
+    // One transaction per row, as when adding transactions from the form
+    QVariantList types, amounts, categories, times;
+    fillBatch(random, AutocommitRows, 0, &types, &amounts, &categories, &times);
+    QElapsedTimer timer;
+    timer.start();
+    query.prepare(insertSql);
+    for (int i = 0; i < AutocommitRows; ++i) {
+        query.bindValue(0, types.at(i));
+        query.bindValue(1, amounts.at(i));
+        query.bindValue(2, categories.at(i));
+        query.bindValue(3, times.at(i));
+        if (!query.exec())
+            return false;
+    }
+    result->autocommit = timer.nsecsElapsed() / 1e9;
+
+    // One transaction for the whole batch, as the CSV importer does
+    types.clear();
+    amounts.clear();
+    categories.clear();
+    times.clear();
+    fillBatch(random, rows, qint64(AutocommitRows) * DayMs / 40, &types, &amounts, &categories, &times);
+    timer.restart();
+    db.transaction();
+    query.prepare(insertSql);
+    query.addBindValue(types);
+    query.addBindValue(amounts);
+    query.addBindValue(categories);
+    query.addBindValue(times);
+    if (!query.execBatch() || !db.commit())
+        return false;
+    result->batched = timer.nsecsElapsed() / 1e9;
+
+    // Totals scan over the whole table
+    timer.restart();
+    for (int pass = 0; pass < 5; ++pass) {
+        if (!exec(query, "SELECT type, SUM(amount_cents), COUNT(*) FROM transactions GROUP BY type"))
+            return false;
+        while (query.next()) {}
+    }
+    result->aggregate = timer.nsecsElapsed() / 1e9 / 5;
+
+    // Keyset pages newest first, as the background loader reads them
+    timer.restart();
+    QSqlQuery page(db);
+    page.prepare("SELECT id, type, amount_cents, description, category_id, datetime_ms FROM transactions "
+                 "WHERE datetime_ms < ? ORDER BY datetime_ms DESC LIMIT ?");
+    qint64 before = std::numeric_limits<qint64>::max();
+    int fetched = 0;
+    for (;;) {
+        page.bindValue(0, before);
+        page.bindValue(1, PageSize);
+        if (!page.exec())
+            return false;
+        int count = 0;
+        while (page.next()) {
+            before = page.value(5).toLongLong();
+            ++count;
+        }
+        fetched += count;
+        if (count < PageSize)
+            break;
+    }
+    result->pages = timer.nsecsElapsed() / 1e9;
+    if (fetched == 0)
+        return false;
+
+    query.finish();
+    page.finish();
+    db.close();
+    return true;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList arguments = app.arguments().mid(1);
+
+    int rows = 200000;
+    if (!arguments.isEmpty() && arguments.first().toInt() > 0)
+        rows = arguments.takeFirst().toInt();
+    if (arguments.isEmpty())
+        arguments = QStringList{"safe", "balanced", "fast"};
+
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        std::printf("error: no temporary directory\n");
+        return 1;
+    }
+
+    std::printf("%d autocommit rows, %d batched rows\n\n", AutocommitRows, rows);
+    std::printf("%-10s %-8s %-7s %14s %14s %12s %12s\n", "profile", "journal", "sync",
+                "autocommit/s", "batched/s", "totals ms", "pages ms");
+
+    for (const QString& name : arguments) {
+        bool ok = false;
+        StorageProfile profile = StorageProfile::preset(name, &ok);
+        if (!ok) {
+            std::printf("unknown profile %s\n", qPrintable(name));
+            continue;
+        }
+
+        Result result;
+        bool success = run(profile, dir.filePath(profile.name + ".db"), rows, &result);
+        QSqlDatabase::removeDatabase(profile.name);
+        if (!success) {
+            std::printf("%-10s failed\n", qPrintable(profile.name));
+            continue;
+        }
+        std::printf("%-10s %-8s %-7s %14.0f %14.0f %12.2f %12.2f\n", qPrintable(profile.name),
+                    qPrintable(profile.journalMode), qPrintable(profile.synchronous),
+                    AutocommitRows / result.autocommit, rows / result.batched,
+                    result.aggregate * 1000.0, result.pages * 1000.0);
+    }
+    return 0;
+}
@@ -0,0 +1,30 @@
+#include "categorydictionary.h"
+
+void CategoryDictionary::clear()
+{
+    names.clear();
+    ids.clear();
+    order.clear();
+}
+
+void CategoryDictionary::insert(int id, const QString& name)
+{
+    if (id < 0 || contains(id))
+        return;
+
+    if (id >= names.size())
+        names.resize(id + 1);
+    names[id] = name.isNull() ? QString("") : name;
+    ids.insert(name, id);
+    order.append(id);
+}
+
+QStringList CategoryDictionary::categoryNames() const
+{
+    QStringList result;
+    result.reserve(order.size());
+    for (int id : order) {
+        result << names.at(id);
+    }
+    return result;
+}
@@ -0,0 +1,104 @@
+#include "connectionpool.h"
+#include <QDebug>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QThread>
+
+ConnectionPool::ConnectionPool()
+    : prefix(QString("pool_%1").arg(quintptr(this), 0, 16))
+    , ownerThread(QThread::currentThread())
+{
+}
+
+ConnectionPool::~ConnectionPool()
+{
+    close();
+}
+
+bool ConnectionPool::open(const QString& databasePath, const StorageProfile& storageProfile)
+{
+    close();
+    path = databasePath;
+    profile = storageProfile;
+    if (ownerThread != QThread::currentThread()) {
+        qDebug() << "Connection pool must be opened on the thread that created it";
+        return false;
+    }
+
+    writerConnection = QSqlDatabase::addDatabase("QSQLITE", prefix + "_writer");
+    writerConnection.setDatabaseName(path);
+    writerConnection.setConnectOptions(profile.connectOptions(false));
+    if (!writerConnection.open()) {
+        qDebug() << "Error opening writer connection:" << writerConnection.lastError().text();
+        return false;
+    }
+    // Journal mode is switched here, before any reader opens
+    profile.apply(writerConnection, false);
+    return true;
+}
+
+void ConnectionPool::close()
+{
+    // Connections of threads that are gone are only removed here
+    QStringList names;
+    {
+        QMutexLocker locker(&mutex);
+        names.swap(threadConnectionNames);
+    }
+    for (const QString& name : names)
+        QSqlDatabase::removeDatabase(name);
+
+    if (writerConnection.isValid()) {
+        QString name = writerConnection.connectionName();
+        writerConnection.close();
+        writerConnection = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+    }
+}
+
+QString ConnectionPool::threadConnectionName(bool readOnly) const
+{
+    return QString("%1_%2_%3").arg(prefix, readOnly ? "reader" : "writer")
+                              .arg(quintptr(QThread::currentThread()), 0, 16);
+}
+
+QSqlDatabase ConnectionPool::threadConnection(bool readOnly)
+{
+    QString name = threadConnectionName(readOnly);
+    if (QSqlDatabase::contains(name)) {
+        QSqlDatabase db = QSqlDatabase::database(name, false);
+        if (db.isOpen())
+            return db;
+        // Left behind by a finished thread at the same address
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+    }
+
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+    db.setDatabaseName(path);
+    db.setConnectOptions(profile.connectOptions(readOnly));
+    if (!db.open()) {
+        qDebug() << "Error opening" << name << ":" << db.lastError().text();
+        return db;
+    }
+    profile.apply(db, readOnly);
+
+    QMutexLocker locker(&mutex);
+    threadConnectionNames.append(name);
+    return db;
+}
+
+void ConnectionPool::releaseThreadConnection(bool readOnly)
+{
+    QString name = threadConnectionName(readOnly);
+    {
+        QMutexLocker locker(&mutex);
+        if (!threadConnectionNames.removeOne(name))
+            return;
+    }
+    {
+        QSqlDatabase db = QSqlDatabase::database(name, false);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+}
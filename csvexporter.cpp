@@ -0,0 +1,206 @@
+#include "csvexporter.h"
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlError>
+
+CsvExporter::CsvExporter(ConnectionPool *connections, const QString& fileName,
+                         const TransactionFilter& filter, bool useFullTextSearch, QObject *parent)
+    : ExportWorker(connections, parent)
+    , fileName(fileName)
+    , filter(filter)
+    , useFullTextSearch(useFullTextSearch)
+{
+}
+
+// UTF-8 encodes straight into the buffer; ASCII takes the fast path
+void CsvExporter::appendText(QByteArray& buffer, QStringView text)
+{
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        char16_t c = text[i].unicode();
+        if (c < 0x80) {
+            buffer.append(char(c));
+        } else {
+            buffer.append(text.mid(i).toUtf8());
+            return;
+        }
+    }
+}
+
+void CsvExporter::appendQuoted(QByteArray& buffer, QStringView text)
+{
+    buffer.append('"');
+    qsizetype start = 0;
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        if (text[i] == u'"') {
+            appendText(buffer, text.mid(start, i - start + 1));
+            buffer.append('"');
+            start = i + 1;
+        }
+    }
+    appendText(buffer, text.mid(start));
+    buffer.append('"');
+}
+
+void CsvExporter::appendAmount(QByteArray& buffer, qint64 cents)
+{
+    // Same output as Money::abs().toString() without the intermediate string
+    if (cents < 0)
+        cents = -cents;
+    char digits[24];
+    int length = 0;
+    qint64 whole = cents / 100;
+    do {
+        digits[length++] = char('0' + whole % 10);
+        whole /= 10;
+    } while (whole > 0);
+    while (length > 0) {
+        buffer.append(digits[--length]);
+    }
+    buffer.append('.');
+    buffer.append(char('0' + (cents / 10) % 10));
+    buffer.append(char('0' + cents % 10));
+}
+
+void CsvExporter::appendDigits(QByteArray& buffer, int value, int width)
+{
+    char digits[12];
+    int length = 0;
+    do {
+        digits[length++] = char('0' + value % 10);
+        value /= 10;
+    } while (value > 0 || length < width);
+    while (length > 0) {
+        buffer.append(digits[--length]);
+    }
+}
+
+void CsvExporter::appendDateTime(QByteArray& buffer, qint64 msecs)
+{
+    // Rows come in time order, so the date text is only rebuilt when a row
+    // leaves the previous local day
+    if (msecs < dayStart || msecs >= dayEnd) {
+        QDate date = QDateTime::fromMSecsSinceEpoch(msecs).date();
+        dayStart = date.startOfDay().toMSecsSinceEpoch();
+        dayEnd = date.addDays(1).startOfDay().toMSecsSinceEpoch();
+        dayText.resize(0);
+        appendDigits(dayText, date.year(), 4);
+        dayText.append('-');
+        appendDigits(dayText, date.month(), 2);
+        dayText.append('-');
+        appendDigits(dayText, date.day(), 2);
+        dayText.append(' ');
+    }
+    buffer.append(dayText);
+
+    // The time of day is the offset from local midnight, except on days
+    // when daylight saving moves the clock
+    int minutes;
+    if (dayEnd - dayStart == 24 * 60 * 60 * 1000) {
+        minutes = int((msecs - dayStart) / (60 * 1000));
+    } else {
+        QTime time = QDateTime::fromMSecsSinceEpoch(msecs).time();
+        minutes = time.hour() * 60 + time.minute();
+    }
+    appendDigits(buffer, minutes / 60, 2);
+    buffer.append(':');
+    appendDigits(buffer, minutes % 60, 2);
+}
+
+// The driver's string, viewed in place rather than copied out with toString()
+static QStringView textOf(const QVariant& value)
+{
+    if (value.typeId() != QMetaType::QString)
+        return QStringView();
+    return *static_cast<const QString *>(value.constData());
+}
+
+bool CsvExporter::exportData(QSqlDatabase& db, QString *message, QString *error)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        *error = "Could not open file for writing.";
+        return false;
+    }
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!DatabaseManager::prepareFilterQuery(query, filter, useFullTextSearch) || !query.exec()) {
+        *error = "Could not read transactions: " + query.lastError().text();
+        return false;
+    }
+
+    QSqlRecord record = query.record();
+    int datetimeColumn = record.indexOf("datetime_ms");
+    int typeColumn = record.indexOf("type");
+    int amountColumn = record.indexOf("amount_cents");
+    int descriptionColumn = record.indexOf("description");
+    int categoryIdColumn = record.indexOf("category_id");
+    int categoryColumn = record.indexOf("category");
+
+    // Each category is encoded once, the first time it comes up
+    QHash<int, QByteArray> categoryFields;
+
+    QByteArray buffer;
+    buffer.reserve(BufferSize + 4096);
+    buffer.append("Date,Type,Amount,Description,Category\n");
+
+    int rows = 0;
+    while (query.next()) {
+        // Stored as epoch milliseconds; the export shows local "yyyy-MM-dd hh:mm"
+        appendDateTime(buffer, query.value(datetimeColumn).toLongLong());
+        buffer.append(',');
+
+        buffer.append(query.value(typeColumn).toInt() == Transaction::Income ? "Income," : "Expense,");
+
+        appendAmount(buffer, query.value(amountColumn).toLongLong());
+        buffer.append(',');
+
+        appendQuoted(buffer, textOf(query.value(descriptionColumn)));
+        buffer.append(',');
+
+        int categoryId = query.value(categoryIdColumn).toInt();
+        auto category = categoryFields.constFind(categoryId);
+        if (category == categoryFields.constEnd()) {
+            QByteArray field;
+            QVariant name = query.value(categoryColumn);
+            QStringView text = textOf(name);
+            if (text.contains(u',') || text.contains(u'"') || text.contains(u'\n')) {
+                appendQuoted(field, text);
+            } else {
+                appendText(field, text);
+            }
+            category = categoryFields.insert(categoryId, field);
+        }
+        buffer.append(category.value());
+        buffer.append('\n');
+
+        if (buffer.size() >= BufferSize) {
+            if (file.write(buffer) != buffer.size()) {
+                *error = "Could not write to file: " + file.errorString();
+                return false;
+            }
+            buffer.resize(0);  // Keeps the allocation, unlike clear()
+        }
+
+        if (++rows % ProgressInterval == 0) {
+            if (isCancelled()) {
+                file.remove();
+                return false;
+            }
+            reportProgress(rows);
+        }
+    }
+
+    if (file.write(buffer) != buffer.size()) {
+        *error = "Could not write to file: " + file.errorString();
+        return false;
+    }
+    file.close();
+
+    reportProgress(rows);
+    *message = QString("%1 transactions exported successfully!").arg(rows);
+    return true;
+}
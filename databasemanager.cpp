@@ -1,39 +1,63 @@
 #include "databasemanager.h"
+#include "storageprofile.h"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QDebug>
+#include <QVariantList>
 #include <QDir>
+#include <QFileInfo>
 #include <QCoreApplication>
+#include <QRegularExpression>
+#include <limits>
+
+// Cached prepares for bulk import and batch edits
+static const QString insertTransactionSql =
+    "INSERT INTO transactions (type, amount_cents, description, category_id, datetime_ms, month_key) "
+    "VALUES (?, ?, ?, ?, ?, ?)";
+static const QString updateTransactionSql =
+    "UPDATE transactions SET type = ?, amount_cents = ?, description = ?, category_id = ?, datetime_ms = ?, "
+    "month_key = ? WHERE id = ?";
+
 DatabaseManager::~DatabaseManager()
 {
-    if (db.isOpen()) {
-        db.close();
-    }
+    statements.logStatistics("Writer");
+    statements.clear();
+    db = QSqlDatabase();
+    pool.close();
 }
 
-bool DatabaseManager::initialize()
+QString DatabaseManager::databasePath()
 {
-    db = QSqlDatabase::addDatabase("QSQLITE");
+    return QCoreApplication::applicationDirPath() + "/finance_tracker.db";
+}
 
-    // Get the application directory path
-    QString appDir = QCoreApplication::applicationDirPath();
-    QString dbPath = appDir + "/finance_tracker.db";
+bool DatabaseManager::initialize(const MigrationProgress& progress)
+{
+    return initialize(databasePath(), progress);
+}
 
+bool DatabaseManager::initialize(const QString& dbPath, const MigrationProgress& progress)
+{
     // Create the directory if it doesn't exist
-    QDir dir(appDir);
+    QDir dir = QFileInfo(dbPath).absoluteDir();
     if (!dir.exists()) {
         dir.mkpath(".");
     }
     qDebug() << "Database path:" << dbPath;  // Debug line to see the path
-    db.setDatabaseName(dbPath);
 
-    if (!db.open()) {
+    StorageProfile profile = StorageProfile::load();
+    qDebug() << "Storage profile:" << profile.name << profile.journalMode << profile.synchronous;
+
+    // Everything below, and every method of this class, runs on the pool's
+    // writer connection; worker threads get their own readers from the pool
+    if (!pool.open(dbPath, profile)) {
         qDebug() << "Error: connection with database failed";
-        qDebug() << "Error details:" << db.lastError().text();
         return false;
     }
+    db = pool.writer();
+    statements.setDatabase(db);
 
-    if (!createTables()) {
+    if (!createTables(progress)) {
         qDebug() << "Error: failed to create tables";
         return false;
     }
@@ -41,110 +65,753 @@ bool DatabaseManager::initialize()
     qDebug() << "Database initialized successfully";
     return true;
 }
-bool DatabaseManager::deleteTransaction(const QString& datetime, double amount, const QString& description)
+
+bool DatabaseManager::updateTransactions(const QVector<Transaction>& transactions)
 {
-    QSqlQuery query;
-    query.prepare("DELETE FROM transactions WHERE datetime = :datetime AND amount = :amount AND description = :description");
-    query.bindValue(":datetime", datetime);
-    query.bindValue(":amount", amount);
-    query.bindValue(":description", description);
+    QVariantList types, amounts, descriptions, categories, datetimes, monthKeys, ids;
+    for (const Transaction& transaction : transactions) {
+        types << int(transaction.type());
+        amounts << transaction.amount().cents();
+        descriptions << transaction.description();
+        categories << transaction.categoryId();
+        datetimes << transaction.datetime().toMSecsSinceEpoch();
+        monthKeys << transaction.monthKey();
+        ids << transaction.id();
+    }
+
+    QSqlQuery *query = statements.prepare(updateTransactionSql);
+    if (!query)
+        return false;
+    query->bindValue(0, types);
+    query->bindValue(1, amounts);
+    query->bindValue(2, descriptions);
+    query->bindValue(3, categories);
+    query->bindValue(4, datetimes);
+    query->bindValue(5, monthKeys);
+    query->bindValue(6, ids);
 
-    if (!query.exec()) {
-        qDebug() << "Error deleting transaction:" << query.lastError().text();
+    if (!db.transaction()) {
+        qDebug() << "Error starting batch update:" << db.lastError().text();
+        return false;
+    }
+    if (!query->execBatch() || !db.commit()) {
+        qDebug() << "Error updating transactions:" << query->lastError().text() << db.lastError().text();
+        db.rollback();
         return false;
     }
 
     return true;
-} //The deleteTransaction method in the DatabaseManager class deletes a specific transaction from the database based on its datetime, amount, and description. It prepares an SQL DELETE query with placeholders, binds the input values to prevent SQL injection, and executes the query. If the deletion succeeds, it returns true; otherwise, it logs an error and returns false. This method ensures precise and secure deletion of transactions while providing clear error handling for debugging.
-bool DatabaseManager::createTables()
-{
-    QSqlQuery query;
-    QString createTableQuery =
-        "CREATE TABLE IF NOT EXISTS transactions ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-        "type INTEGER NOT NULL,"
-        "amount REAL NOT NULL,"
-        "description TEXT,"
-        "category TEXT,"
-        "datetime TEXT NOT NULL"
-        ")";
+}
+
+// Shared by table creation and the migration that rebuilds the table
+static QString createTransactionsTableSql(const QString& tableName)
+{
+    return "CREATE TABLE IF NOT EXISTS " + tableName + " ("
+           "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+           "type INTEGER NOT NULL,"
+           "amount_cents INTEGER NOT NULL,"
+           "description TEXT,"
+           "category_id INTEGER NOT NULL REFERENCES categories(id),"
+           "datetime_ms INTEGER NOT NULL,"
+           "month_key INTEGER NOT NULL"
+           ")";
+}
+
+// Local calendar month of an epoch-ms expression as year * 12 + month - 1,
+// for filling month_key on rows migrated from before it was stored.
+// SQLite's 'localtime' and QDateTime both follow the system time zone.
+static QString monthKeySql(const QString& msecs)
+{
+    QString local = "strftime('%1', " + msecs + " / 1000, 'unixepoch', 'localtime')";
+    return "(CAST(" + local.arg("%Y") + " AS INTEGER) * 12 + CAST(" + local.arg("%m") + " AS INTEGER) - 1)";
+}
+
+// Totals per (month, category, type), maintained by triggers on transactions
+static const char *createSummaryTableSql =
+    "CREATE TABLE IF NOT EXISTS transaction_summary ("
+    "month INTEGER NOT NULL,"
+    "category_id INTEGER NOT NULL,"
+    "type INTEGER NOT NULL,"
+    "total_cents INTEGER NOT NULL,"
+    "row_count INTEGER NOT NULL,"
+    "PRIMARY KEY (month, category_id, type)"
+    ") WITHOUT ROWID";
 
-    if (!query.exec(createTableQuery)) {
-        qDebug() << "Error creating table:" << query.lastError().text();
+bool DatabaseManager::createTables(const MigrationProgress& progress)
+{
+    QSqlQuery query(db);
+
+    // SQLite only enforces REFERENCES when asked to, per connection
+    query.exec("PRAGMA foreign_keys = ON");
+
+    if (!query.exec("CREATE TABLE IF NOT EXISTS categories ("
+                    "id INTEGER PRIMARY KEY,"
+                    "name TEXT NOT NULL UNIQUE"
+                    ")")) {
+        qDebug() << "Error creating categories table:" << query.lastError().text();
+        return false;
+    }
+
+    // A new database starts with the categories the form used to hard-code
+    query.exec("SELECT COUNT(*) FROM categories");
+    if (query.next() && query.value(0).toInt() == 0) {
+        query.prepare("INSERT INTO categories (name) VALUES (?)");
+        query.addBindValue(QVariantList{"Salary", "Food", "Transport", "Entertainment", "Bills", "Shopping", "Other"});
+        if (!query.execBatch()) {
+            qDebug() << "Error creating default categories:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    // A new database gets the current layout and version directly; older
+    // ones are brought up to it one step at a time
+    if (!hasTable("transactions")) {
+        if (!runInTransaction({createTransactionsTableSql("transactions"),
+                               QString("PRAGMA user_version = %1").arg(SchemaVersion)})) {
+            qDebug() << "Error creating table";
+            return false;
+        }
+    } else if (!migrate(progress)) {
+        return false;
+    }
+
+    // Indexes backing the sort order and the filter query
+    const QStringList createIndexQueries = {
+        "CREATE INDEX IF NOT EXISTS idx_transactions_datetime ON transactions(datetime_ms)",
+        "CREATE INDEX IF NOT EXISTS idx_transactions_category ON transactions(category_id)",
+        "CREATE INDEX IF NOT EXISTS idx_transactions_amount ON transactions(amount_cents)"
+    };
+    for (const QString& createIndexQuery : createIndexQueries) {
+        if (!query.exec(createIndexQuery)) {
+            qDebug() << "Error creating index:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    if (!query.exec(createSummaryTableSql) || !createSummaryTriggers()) {
+        qDebug() << "Error creating summary table:" << query.lastError().text();
+        return false;
+    }
+
+    if (!loadCategories()) {
         return false;
     }
 
+    ftsAvailable = createSearchIndex();
+
     qDebug() << "Tables created successfully";
     return true;
 }
 
-bool DatabaseManager::addTransaction(const Transaction& transaction)
+bool DatabaseManager::hasTable(const QString& table)
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = :name");
+    query.bindValue(":name", table);
+    return query.exec() && query.next();
+}
+
+bool DatabaseManager::hasColumn(const QString& table, const QString& column)
+{
+    QSqlQuery query(db);
+    query.exec("PRAGMA table_info(" + table + ")");
+    while (query.next()) {
+        if (query.value("name").toString() == column) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int DatabaseManager::schemaVersion()
+{
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA user_version") || !query.next()) {
+        return 0;
+    }
+    return query.value(0).toInt();
+}
+
+int DatabaseManager::unversionedSchemaVersion()
+{
+    // Early builds never set user_version, so the layout tells which steps
+    // have already been applied
+    if (hasColumn("transactions", "category")) {
+        return 0;
+    }
+    if (hasColumn("transactions", "amount")) {
+        return 1;
+    }
+    if (hasColumn("transactions", "datetime")) {
+        return 2;
+    }
+    if (hasColumn("transactions", "month_key")) {
+        return 5;
+    }
+    return hasTable("transaction_summary") ? 4 : 3;
+}
+
+QVector<DatabaseManager::Migration> DatabaseManager::migrations()
+{
+    return {
+        {1, "Moving categories into their own table",
+         // The old search index was built over the text column; it is
+         // dropped here and rebuilt by createSearchIndex()
+         {"DROP TRIGGER IF EXISTS transactions_fts_insert",
+          "DROP TRIGGER IF EXISTS transactions_fts_delete",
+          "DROP TRIGGER IF EXISTS transactions_fts_update",
+          "DROP TABLE IF EXISTS transactions_fts",
+          "INSERT OR IGNORE INTO categories (name) "
+          "SELECT DISTINCT COALESCE(NULLIF(category, ''), 'Other') FROM transactions"},
+         "CREATE TABLE IF NOT EXISTS transactions_migrated ("
+         "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+         "type INTEGER NOT NULL,"
+         "amount REAL NOT NULL,"
+         "description TEXT,"
+         "category_id INTEGER NOT NULL REFERENCES categories(id),"
+         "datetime TEXT NOT NULL"
+         ")",
+         "INSERT INTO transactions_migrated (id, type, amount, description, category_id, datetime) "
+         "SELECT t.id, t.type, t.amount, t.description, c.id, t.datetime FROM transactions t "
+         "JOIN categories c ON c.name = COALESCE(NULLIF(t.category, ''), 'Other') "
+         "WHERE t.id > :lastId ORDER BY t.id LIMIT :limit"},
+
+        {2, "Converting amounts to integer cents",
+         {},
+         "CREATE TABLE IF NOT EXISTS transactions_migrated ("
+         "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+         "type INTEGER NOT NULL,"
+         "amount_cents INTEGER NOT NULL,"
+         "description TEXT,"
+         "category_id INTEGER NOT NULL REFERENCES categories(id),"
+         "datetime TEXT NOT NULL"
+         ")",
+         "INSERT INTO transactions_migrated (id, type, amount_cents, description, category_id, datetime) "
+         "SELECT id, type, CAST(ROUND(amount * 100) AS INTEGER), description, category_id, datetime "
+         "FROM transactions WHERE id > :lastId ORDER BY id LIMIT :limit"},
+
+        // The 'utc' modifier reads zone-less text as local time, as Qt did;
+        // text with an explicit offset is already absolute. Unparseable
+        // values become the epoch rather than losing the row.
+        {3, "Converting dates to epoch milliseconds",
+         {},
+         "CREATE TABLE IF NOT EXISTS transactions_migrated ("
+         "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+         "type INTEGER NOT NULL,"
+         "amount_cents INTEGER NOT NULL,"
+         "description TEXT,"
+         "category_id INTEGER NOT NULL REFERENCES categories(id),"
+         "datetime_ms INTEGER NOT NULL"
+         ")",
+         "INSERT INTO transactions_migrated (id, type, amount_cents, description, category_id, datetime_ms) "
+         "SELECT id, type, amount_cents, description, category_id, "
+         "COALESCE(CAST(ROUND((julianday(datetime, 'utc') - 2440587.5) * 86400000) AS INTEGER), 0) "
+         "FROM transactions WHERE id > :lastId ORDER BY id LIMIT :limit"},
+
+        // One grouped pass fills the summary; the triggers that keep it
+        // current are created with the other triggers in createTables()
+        {4, "Building monthly summaries",
+         {createSummaryTableSql,
+          "DELETE FROM transaction_summary",
+          "INSERT INTO transaction_summary (month, category_id, type, total_cents, row_count) "
+          "SELECT " + monthKeySql("datetime_ms") + ", category_id, type, SUM(ABS(amount_cents)), COUNT(*) "
+          "FROM transactions GROUP BY 1, 2, 3"},
+         QString(),
+         QString(),
+         {}},
+
+        // The month is computed once here and stored with each row, so the
+        // summary triggers no longer depend on the time zone at write time.
+        // The summary is rebuilt from the stored keys with the table swap.
+        {5, "Storing each transaction's summary month",
+         {},
+         createTransactionsTableSql("transactions_migrated"),
+         "INSERT INTO transactions_migrated (id, type, amount_cents, description, category_id, datetime_ms, month_key) "
+         "SELECT id, type, amount_cents, description, category_id, datetime_ms, " + monthKeySql("datetime_ms") + " "
+         "FROM transactions WHERE id > :lastId ORDER BY id LIMIT :limit",
+         {"DELETE FROM transaction_summary",
+          "INSERT INTO transaction_summary (month, category_id, type, total_cents, row_count) "
+          "SELECT month_key, category_id, type, SUM(ABS(amount_cents)), COUNT(*) "
+          "FROM transactions GROUP BY 1, 2, 3"}}
+    };
+}
+
+bool DatabaseManager::migrate(const MigrationProgress& progress)
+{
+    int version = schemaVersion();
+    if (version > SchemaVersion) {
+        qDebug() << "Database schema version" << version << "is newer than this build supports";
+        return false;
+    }
+    if (version == 0) {
+        version = unversionedSchemaVersion();
+    }
+
+    for (const Migration& migration : migrations()) {
+        if (migration.version <= version) {
+            continue;
+        }
+        qDebug() << "Migrating database to version" << migration.version << "-" << migration.description;
+        if (!runMigration(migration, progress)) {
+            return false;
+        }
+        version = migration.version;
+    }
+
+    // Databases from unversioned builds that already had the latest layout
+    if (schemaVersion() != version
+        && !runInTransaction({QString("PRAGMA user_version = %1").arg(version)})) {
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::runMigration(const Migration& migration, const MigrationProgress& progress)
 {
-    QSqlQuery query;
-    query.prepare("INSERT INTO transactions (type, amount, description, category, datetime) "
-                  "VALUES (:type, :amount, :description, :category, :datetime)");
+    QString setVersion = QString("PRAGMA user_version = %1").arg(migration.version);
+    if (migration.createTable.isEmpty()) {
+        return runInTransaction(migration.prepare + QStringList{setVersion});
+    }
+
+    if (!runInTransaction(migration.prepare + QStringList{migration.createTable})) {
+        return false;
+    }
+
+    // Rows are copied in id order, one committed chunk at a time, so the UI
+    // gets progress between chunks. A run that was interrupted leaves the
+    // copied rows behind and picks up after the last one.
+    QSqlQuery query(db);
+    int total = 0;
+    int done = 0;
+    qint64 lastId = std::numeric_limits<qint64>::min();
+    if (query.exec("SELECT COUNT(*) FROM transactions") && query.next()) {
+        total = query.value(0).toInt();
+    }
+    if (query.exec("SELECT COUNT(*), MAX(id) FROM transactions_migrated") && query.next()) {
+        done = query.value(0).toInt();
+        if (done > 0) {
+            lastId = query.value(1).toLongLong();
+        }
+    }
+
+    QSqlQuery copy(db);
+    if (!copy.prepare(migration.copyRows)) {
+        qDebug() << "Error preparing migration:" << copy.lastError().text();
+        return false;
+    }
+
+    forever {
+        if (progress) {
+            progress(migration.description, done, total);
+        }
+
+        if (!db.transaction()) {
+            qDebug() << "Error starting migration chunk:" << db.lastError().text();
+            return false;
+        }
+        copy.bindValue(":lastId", lastId);
+        copy.bindValue(":limit", MigrationChunkSize);
+        if (!copy.exec() || !query.exec("SELECT MAX(id) FROM transactions_migrated") || !query.next()) {
+            qDebug() << "Error migrating rows:" << copy.lastError().text() << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+        int copied = copy.numRowsAffected();
+        qint64 maxId = query.value(0).toLongLong();
+        query.finish();
+        if (!db.commit()) {
+            qDebug() << "Error committing migration chunk:" << db.lastError().text();
+            db.rollback();
+            return false;
+        }
 
-    query.bindValue(":type", transaction.type());
-    query.bindValue(":amount", transaction.amount());
-    query.bindValue(":description", transaction.description());
-    query.bindValue(":category", transaction.category());
-    query.bindValue(":datetime", transaction.datetime().toString(Qt::ISODate));
+        if (copied <= 0) {
+            break;
+        }
+        done += copied;
+        lastId = maxId;
+    }
+
+    // Dropping the table also drops its indexes and search triggers;
+    // createTables() and createSearchIndex() recreate them afterwards
+    return runInTransaction({
+        "DROP TABLE transactions",
+        "ALTER TABLE transactions_migrated RENAME TO transactions"
+    } + migration.finish + QStringList{setVersion});
+}
+
+bool DatabaseManager::runInTransaction(const QStringList& statements)
+{
+    // Each migration step is all-or-nothing
+    if (!db.transaction()) {
+        qDebug() << "Error starting migration:" << db.lastError().text();
+        return false;
+    }
 
-    if (!query.exec()) {
-        qDebug() << "Error adding transaction:" << query.lastError().text();
+    QSqlQuery query(db);
+    for (const QString& statement : statements) {
+        if (!query.exec(statement)) {
+            qDebug() << "Error migrating database:" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    if (!db.commit()) {
+        qDebug() << "Error committing migration:" << db.lastError().text();
+        db.rollback();
         return false;
     }
 
     return true;
 }
 
-QVector<Transaction> DatabaseManager::getAllTransactions()
+bool DatabaseManager::loadCategories()
 {
-    QVector<Transaction> transactions;
-    QSqlQuery query("SELECT * FROM transactions ORDER BY datetime DESC");
+    categoryDictionary.clear();
 
+    QSqlQuery query(db);
+    if (!query.exec("SELECT id, name FROM categories ORDER BY id")) {
+        qDebug() << "Error loading categories:" << query.lastError().text();
+        return false;
+    }
     while (query.next()) {
-        Transaction::Type type = static_cast<Transaction::Type>(query.value("type").toInt());
-        double amount = query.value("amount").toDouble();
-        QString description = query.value("description").toString();
-        QString category = query.value("category").toString();
-        QDateTime datetime = QDateTime::fromString(query.value("datetime").toString(), Qt::ISODate);
+        categoryDictionary.insert(query.value(0).toInt(), query.value(1).toString());
+    }
+    return true;
+}
+
+int DatabaseManager::categoryId(const QString& name)
+{
+    QString trimmed = name.trimmed();
+    if (trimmed.isEmpty()) {
+        trimmed = "Other";
+    }
+
+    int id = categoryDictionary.id(trimmed);
+    if (id >= 0) {
+        return id;
+    }
 
-        transactions.append(Transaction(type, amount, description, category, datetime));
+    QSqlQuery *query = statements.prepare("INSERT INTO categories (name) VALUES (?)");
+    if (!query)
+        return -1;
+    query->bindValue(0, trimmed);
+    if (!query->exec()) {
+        qDebug() << "Error adding category:" << query->lastError().text();
+        return -1;
     }
 
-    return transactions;
+    id = query->lastInsertId().toInt();
+    categoryDictionary.insert(id, trimmed);
+    return id;
+}
+
+bool DatabaseManager::createSummaryTriggers()
+{
+    // Every write to transactions moves its absolute amount between summary
+    // rows; rows whose count drops to zero are removed
+    QString addNew =
+        "INSERT INTO transaction_summary (month, category_id, type, total_cents, row_count) "
+        "VALUES (new.month_key, new.category_id, new.type, ABS(new.amount_cents), 1) "
+        "ON CONFLICT (month, category_id, type) DO UPDATE SET "
+        "total_cents = total_cents + excluded.total_cents, row_count = row_count + 1; ";
+    QString oldKey = "month = old.month_key AND category_id = old.category_id AND type = old.type";
+    QString removeOld =
+        "UPDATE transaction_summary SET total_cents = total_cents - ABS(old.amount_cents), "
+        "row_count = row_count - 1 WHERE " + oldKey + "; "
+        "DELETE FROM transaction_summary WHERE " + oldKey + " AND row_count <= 0; ";
+
+    const QStringList createTriggerQueries = {
+        "CREATE TRIGGER IF NOT EXISTS transaction_summary_insert AFTER INSERT ON transactions BEGIN "
+        + addNew + "END",
+        "CREATE TRIGGER IF NOT EXISTS transaction_summary_delete AFTER DELETE ON transactions BEGIN "
+        + removeOld + "END",
+        "CREATE TRIGGER IF NOT EXISTS transaction_summary_update "
+        "AFTER UPDATE OF type, amount_cents, category_id, month_key ON transactions BEGIN "
+        + removeOld + addNew + "END"
+    };
+
+    QSqlQuery query(db);
+    for (const QString& createTriggerQuery : createTriggerQueries) {
+        if (!query.exec(createTriggerQuery)) {
+            qDebug() << "Error creating summary trigger:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DatabaseManager::createSearchIndex()
+{
+    QSqlQuery query(db);
+
+    query.exec("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'transactions_fts'");
+    bool indexExists = query.next();
+
+    // Contentless FTS5 index over the description and the category name; the
+    // rowid is the transaction id, so matches join straight back to the table.
+    // Only MATCH, rowid and rank are ever read, so no copy of the text is kept.
+    QString createIndexQuery =
+        "CREATE VIRTUAL TABLE IF NOT EXISTS transactions_fts USING fts5("
+        "description, category,"
+        "content='',"
+        "tokenize='unicode61 remove_diacritics 2', prefix='2 3'"
+        ")";
+
+    if (!query.exec(createIndexQuery)) {
+        qDebug() << "FTS5 unavailable, search falls back to LIKE:" << query.lastError().text();
+        return false;
+    }
+
+    // Triggers keep the index in sync with every write to transactions
+    const QStringList createTriggerQueries = {
+        "CREATE TRIGGER IF NOT EXISTS transactions_fts_insert AFTER INSERT ON transactions BEGIN "
+        "INSERT INTO transactions_fts(rowid, description, category) "
+        "SELECT new.id, new.description, name FROM categories WHERE id = new.category_id; "
+        "END",
+        "CREATE TRIGGER IF NOT EXISTS transactions_fts_delete AFTER DELETE ON transactions BEGIN "
+        "INSERT INTO transactions_fts(transactions_fts, rowid, description, category) "
+        "SELECT 'delete', old.id, old.description, name FROM categories WHERE id = old.category_id; "
+        "END",
+        "CREATE TRIGGER IF NOT EXISTS transactions_fts_update AFTER UPDATE ON transactions BEGIN "
+        "INSERT INTO transactions_fts(transactions_fts, rowid, description, category) "
+        "SELECT 'delete', old.id, old.description, name FROM categories WHERE id = old.category_id; "
+        "INSERT INTO transactions_fts(rowid, description, category) "
+        "SELECT new.id, new.description, name FROM categories WHERE id = new.category_id; "
+        "END"
+    };
+    for (const QString& createTriggerQuery : createTriggerQueries) {
+        if (!query.exec(createTriggerQuery)) {
+            qDebug() << "Error creating search trigger:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    // Index rows that were written before the search index existed
+    if (!indexExists && !query.exec("INSERT INTO transactions_fts(rowid, description, category) "
+                                    "SELECT t.id, t.description, c.name FROM transactions t "
+                                    "JOIN categories c ON c.id = t.category_id")) {
+        qDebug() << "Error building search index:" << query.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+// Turns free text into an FTS5 query: every word becomes a quoted prefix
+// term, and terms are implicitly ANDed
+static QString ftsMatchExpression(const QString& text)
+{
+    static const QRegularExpression separators("[^\\w]+", QRegularExpression::UseUnicodePropertiesOption);
+    QStringList terms;
+    for (const QString& word : text.split(separators, Qt::SkipEmptyParts)) {
+        terms << "\"" + word + "\"*";
+    }
+    return terms.join(' ');
 }
 
-double DatabaseManager::getTotalBalance()
+int DatabaseManager::addTransactions(const QVector<Transaction>& transactions,
+                                     const std::function<bool(int)>& progress)
 {
-    QSqlQuery query;
-    query.exec("SELECT SUM(CASE WHEN type = 0 THEN amount ELSE -amount END) FROM transactions");
+    // One prepared statement is reused for the whole import, and each chunk
+    // is committed as a single transaction instead of one fsync per row
+    QSqlQuery *query = statements.prepare(insertTransactionSql);
+    if (!query)
+        return 0;
 
-    if (query.next()) {
-        return query.value(0).toDouble();
+    int written = 0;
+    while (written < transactions.size()) {
+        int count = qMin(BulkInsertChunkSize, int(transactions.size()) - written);
+
+        QVariantList types, amounts, descriptions, categories, datetimes, monthKeys;
+        types.reserve(count);
+        amounts.reserve(count);
+        descriptions.reserve(count);
+        categories.reserve(count);
+        datetimes.reserve(count);
+        monthKeys.reserve(count);
+        for (int i = written; i < written + count; ++i) {
+            const Transaction& transaction = transactions.at(i);
+            types << int(transaction.type());
+            amounts << transaction.amount().cents();
+            descriptions << transaction.description();
+            categories << transaction.categoryId();
+            datetimes << transaction.datetime().toMSecsSinceEpoch();
+            monthKeys << transaction.monthKey();
+        }
+
+        query->bindValue(0, types);
+        query->bindValue(1, amounts);
+        query->bindValue(2, descriptions);
+        query->bindValue(3, categories);
+        query->bindValue(4, datetimes);
+        query->bindValue(5, monthKeys);
+
+        if (!db.transaction()) {
+            qDebug() << "Error starting bulk insert:" << db.lastError().text();
+            return written;
+        }
+        if (!query->execBatch()) {
+            qDebug() << "Error in bulk insert:" << query->lastError().text();
+            db.rollback();
+            return written;
+        }
+        if (!db.commit()) {
+            qDebug() << "Error committing bulk insert:" << db.lastError().text();
+            db.rollback();
+            return written;
+        }
+
+        written += count;
+        if (progress && !progress(written)) {
+            break;
+        }
     }
-    return 0.0;
+
+    return written;
+}
+
+Transaction DatabaseManager::transactionFromQuery(const QSqlQuery& query)
+{
+    Transaction::Type type = static_cast<Transaction::Type>(query.value("type").toInt());
+    Money amount = Money::fromCents(query.value("amount_cents").toLongLong());
+    QString description = query.value("description").toString();
+    int categoryId = query.value("category_id").toInt();
+    QDateTime datetime = QDateTime::fromMSecsSinceEpoch(query.value("datetime_ms").toLongLong());
+    qint64 id = query.value("id").toLongLong();
+
+    return Transaction(type, amount, description, categoryId, datetime, id);
 }
 
-double DatabaseManager::getTotalIncome()
+bool DatabaseManager::prepareFilterQuery(QSqlQuery& query, const TransactionFilter& filter, bool useFullTextSearch,
+                                         const QString& sortOrder)
 {
-    QSqlQuery query;
-    query.exec("SELECT SUM(amount) FROM transactions WHERE type = 0");
+    QStringList conditions;
+    QString from = "transactions t JOIN categories c ON c.id = t.category_id";
+    QString orderBy = "t.datetime_ms DESC";
 
-    if (query.next()) {
-        return query.value(0).toDouble();
+    QString matchExpression;
+    if (!filter.searchText.isEmpty() && useFullTextSearch) {
+        matchExpression = ftsMatchExpression(filter.searchText);
+    }
+
+    if (!matchExpression.isEmpty()) {
+        // Token/prefix search through the FTS index, best matches first
+        from += " JOIN transactions_fts ON transactions_fts.rowid = t.id";
+        conditions << "transactions_fts MATCH :search";
+        orderBy = "transactions_fts.rank, " + orderBy;
+    } else if (!filter.searchText.isEmpty()) {
+        conditions << "(t.description LIKE :search ESCAPE '\\' OR c.name LIKE :search ESCAPE '\\')";
+    }
+    if (filter.categoryId >= 0) {
+        conditions << "t.category_id = :categoryId";
     }
-    return 0.0;
+
+    // Expenses are stored negative, so an absolute range becomes two amount
+    // ranges that the amount index can serve
+    if (filter.hasMinAmount && filter.hasMaxAmount) {
+        conditions << "(t.amount_cents BETWEEN :minAmount AND :maxAmount "
+                      "OR t.amount_cents BETWEEN :negMaxAmount AND :negMinAmount)";
+    } else if (filter.hasMinAmount) {
+        conditions << "(t.amount_cents >= :minAmount OR t.amount_cents <= :negMinAmount)";
+    } else if (filter.hasMaxAmount) {
+        conditions << "t.amount_cents BETWEEN :negMaxAmount AND :maxAmount";
+    }
+
+    // Date bounds are integer range scans on the datetime index
+    if (filter.startDate.isValid()) {
+        conditions << "t.datetime_ms >= :startDate";
+    }
+    if (filter.endDate.isValid()) {
+        conditions << "t.datetime_ms < :endDate";
+    }
+
+    // The category name rides along for the exporters
+    QString sql = "SELECT t.*, c.name AS category FROM " + from;
+    if (!conditions.isEmpty()) {
+        sql += " WHERE " + conditions.join(" AND ");
+    }
+    sql += " ORDER BY " + (sortOrder.isEmpty() ? orderBy : sortOrder);
+
+    if (!query.prepare(sql)) {
+        qDebug() << "Error preparing filter query:" << query.lastError().text();
+        return false;
+    }
+
+    if (!matchExpression.isEmpty()) {
+        query.bindValue(":search", matchExpression);
+    } else if (!filter.searchText.isEmpty()) {
+        QString pattern = filter.searchText;
+        pattern.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_");
+        query.bindValue(":search", "%" + pattern + "%");
+    }
+    if (filter.categoryId >= 0) {
+        query.bindValue(":categoryId", filter.categoryId);
+    }
+    if (filter.hasMinAmount) {
+        query.bindValue(":minAmount", filter.minAmount.cents());
+        query.bindValue(":negMinAmount", (-filter.minAmount).cents());
+    }
+    if (filter.hasMaxAmount) {
+        query.bindValue(":maxAmount", filter.maxAmount.cents());
+        query.bindValue(":negMaxAmount", (-filter.maxAmount).cents());
+    }
+    if (filter.startDate.isValid()) {
+        query.bindValue(":startDate", filter.startDate.startOfDay().toMSecsSinceEpoch());
+    }
+    if (filter.endDate.isValid()) {
+        query.bindValue(":endDate", filter.endDate.addDays(1).startOfDay().toMSecsSinceEpoch());
+    }
+
+    return true;
+}
+
+Money DatabaseManager::getTotalBalance()
+{
+    return summaryTotal("SELECT SUM(CASE WHEN type = 0 THEN total_cents ELSE -total_cents END) FROM transaction_summary");
 }
 
-double DatabaseManager::getTotalExpenses()
+Money DatabaseManager::getTotalIncome()
 {
-    QSqlQuery query;
-    query.exec("SELECT SUM(amount) FROM transactions WHERE type = 1");
+    return summaryTotal("SELECT SUM(total_cents) FROM transaction_summary WHERE type = 0");
+}
+
+Money DatabaseManager::getTotalExpenses()
+{
+    return summaryTotal("SELECT SUM(total_cents) FROM transaction_summary WHERE type = 1");
+}
+
+Money DatabaseManager::summaryTotal(const QString& sql)
+{
+    QSqlQuery *query = statements.prepare(sql);
+    if (!query || !query->exec() || !query->next())
+        return Money();
+
+    Money total = Money::fromCents(query->value(0).toLongLong());
+    query->finish();
+    return total;
+}
+
+QVector<TransactionSummary> DatabaseManager::getSummary()
+{
+    QVector<TransactionSummary> rows;
+    QSqlQuery *query = statements.prepare("SELECT month, category_id, type, total_cents, row_count "
+                                          "FROM transaction_summary ORDER BY month, category_id, type");
+    if (!query)
+        return rows;
+    if (!query->exec()) {
+        qDebug() << "Error reading summary:" << query->lastError().text();
+        return rows;
+    }
 
-    if (query.next()) {
-        return query.value(0).toDouble();
+    while (query->next()) {
+        TransactionSummary row;
+        row.monthKey = query->value(0).toInt();
+        row.categoryId = query->value(1).toInt();
+        row.type = static_cast<Transaction::Type>(query->value(2).toInt());
+        row.total = Money::fromCents(query->value(3).toLongLong());
+        row.count = query->value(4).toInt();
+        rows.append(row);
     }
-    return 0.0;
+    return rows;
 }
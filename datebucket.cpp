@@ -0,0 +1,94 @@
+#include "datebucket.h"
+#include <QDateTime>
+
+// Julian day 0 is a Monday, so weeks are plain multiples of seven days
+static qint64 floorDiv(qint64 value, qint64 divisor)
+{
+    qint64 quotient = value / divisor;
+    return (value % divisor < 0) ? quotient - 1 : quotient;
+}
+
+qint64 DateBucket::key(Granularity granularity, qint64 julianDay)
+{
+    if (granularity == Day)
+        return julianDay;
+    if (granularity == Week)
+        return floorDiv(julianDay, 7);
+
+    QDate date = QDate::fromJulianDay(julianDay);
+    switch (granularity) {
+    case Month:
+        return qint64(date.year()) * 12 + date.month() - 1;
+    case Quarter:
+        return qint64(date.year()) * 4 + (date.month() - 1) / 3;
+    default:
+        return date.year();
+    }
+}
+
+qint64 DateBucket::keyFromMonth(Granularity granularity, qint64 monthKey)
+{
+    switch (granularity) {
+    case Quarter:
+        return floorDiv(monthKey, 3);
+    case Year:
+        return floorDiv(monthKey, 12);
+    default:
+        return monthKey;
+    }
+}
+
+QDate DateBucket::periodStart(Granularity granularity, qint64 key)
+{
+    switch (granularity) {
+    case Day:
+        return QDate::fromJulianDay(key);
+    case Week:
+        return QDate::fromJulianDay(key * 7);
+    case Month:
+        return QDate(int(floorDiv(key, 12)), int(key - floorDiv(key, 12) * 12) + 1, 1);
+    case Quarter:
+        return QDate(int(floorDiv(key, 4)), int(key - floorDiv(key, 4) * 4) * 3 + 1, 1);
+    default:
+        return QDate(int(key), 1, 1);
+    }
+}
+
+QString DateBucket::label(Granularity granularity, qint64 key)
+{
+    QDate start = periodStart(granularity, key);
+    switch (granularity) {
+    case Day:
+        return start.toString("yyyy-MM-dd");
+    case Week: {
+        int year = 0;
+        int week = start.weekNumber(&year);
+        return QString("%1-W%2").arg(year).arg(week, 2, 10, QChar('0'));
+    }
+    case Month:
+        return start.toString("yyyy-MM");
+    case Quarter:
+        return QString("%1 Q%2").arg(start.year()).arg((start.month() - 1) / 3 + 1);
+    default:
+        return QString::number(start.year());
+    }
+}
+
+QString DateBucket::name(Granularity granularity)
+{
+    switch (granularity) {
+    case Day:     return "Day";
+    case Week:    return "Week";
+    case Month:   return "Month";
+    case Quarter: return "Quarter";
+    default:      return "Year";
+    }
+}
+
+void DayKeyCache::load(qint64 msecs)
+{
+    QDate date = QDateTime::fromMSecsSinceEpoch(msecs).date();
+    dayStart = date.startOfDay().toMSecsSinceEpoch();
+    dayEnd = date.addDays(1).startOfDay().toMSecsSinceEpoch();
+    day = date.toJulianDay();
+}
@@ -0,0 +1,49 @@
+#include "exportworker.h"
+#include <QSqlError>
+#include <QDebug>
+
+ExportWorker::ExportWorker(ConnectionPool *connections, QObject *parent)
+    : QObject(parent)
+    , connections(connections)
+    , cancelled(false)
+{
+}
+
+void ExportWorker::cancel()
+{
+    cancelled.store(true);
+}
+
+bool ExportWorker::isCancelled() const
+{
+    return cancelled.load(std::memory_order_relaxed);
+}
+
+void ExportWorker::reportProgress(int rows)
+{
+    emit progressChanged(rows);
+}
+
+void ExportWorker::run()
+{
+    QString message;
+    QString error;
+    bool success = false;
+
+    {
+        // The reader belongs to the export thread and only lives for the
+        // duration of the export
+        QSqlDatabase db = connections->reader();
+        if (!db.isOpen()) {
+            error = "Could not open the database: " + db.lastError().text();
+        } else {
+            success = exportData(db, &message, &error);
+        }
+    }
+    connections->releaseReader();
+
+    if (!success && isCancelled()) {
+        error = "Export cancelled.";
+    }
+    emit finished(success, success ? message : error);
+}
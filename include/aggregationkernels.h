@@ -0,0 +1,46 @@
+#ifndef AGGREGATIONKERNELS_H
+#define AGGREGATIONKERNELS_H
+
+#include <QtGlobal>
+
+// Reductions over the columns of a TransactionStore: signed amounts in cents
+// and a per-row type byte (Transaction::Type, 0 or 1). Each kernel
+// has an AVX2, an SSE2 and a scalar implementation; the fastest one the CPU
+// supports is picked on first use.
+namespace AggregationKernels
+{
+
+enum class Path {
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+struct TypeTotals {
+    qint64 incomeCents = 0;    // Absolute
+    qint64 expenseCents = 0;   // Absolute
+    qint64 incomeCount = 0;
+    qint64 expenseCount = 0;
+};
+
+// The implementation in use, and its name for logs and the benchmark
+Path activePath();
+const char *pathName(Path path);
+bool isSupported(Path path);
+// Overrides the detected path; returns false if the CPU lacks it
+bool setPath(Path path);
+
+// Absolute income and expense sums and counts over count rows
+TypeTotals sumByType(const qint64 *cents, const quint8 *types, qsizetype count);
+
+// Rollup by an integer key such as a category id or a month index: the
+// absolute amount of row i is added to totals[keys[i] * 2 + types[i]] and
+// counts[...] is incremented, so both arrays need 2 * (largest key + 1)
+// entries, even slots holding income and odd slots expenses. Runs of equal
+// keys, as in time-sorted rows, take the vectorized path.
+void sumByKey(const qint64 *cents, const quint8 *types, const qint32 *keys, qsizetype count,
+              qint64 *totals, qint64 *counts);
+
+}
+
+#endif // AGGREGATIONKERNELS_H
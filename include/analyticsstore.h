@@ -0,0 +1,99 @@
+#ifndef ANALYTICSSTORE_H
+#define ANALYTICSSTORE_H
+
+#include <QMap>
+#include <QList>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+#include <limits>
+
+#include "transactionstore.h"
+#include "datebucket.h"
+
+struct TransactionSummary;
+
+// Running aggregates behind the analytics page. Category and monthly totals
+// are seeded from the database summary table, so they are complete before
+// any row is loaded; loaded rows add the per-day buckets and the balance
+// trend. Every insert or delete then touches one entry per aggregate.
+class AnalyticsStore
+{
+public:
+    // Totals are exact; callers convert to double only for the charts
+    struct CategoryTotal {
+        Money amount;
+        int count = 0;
+    };
+
+    struct PeriodTotal {
+        Money income;
+        Money expenses;
+        int count = 0;
+    };
+
+    struct Period {
+        qint64 key;  // DateBucket key at the requested granularity
+        PeriodTotal total;
+    };
+
+    void clear();
+    // Category and month totals for every stored transaction
+    void loadSummary(const QVector<TransactionSummary>& summary);
+    void addTransaction(const Transaction& transaction);
+    void removeTransaction(const Transaction& transaction);
+    // Bulk path for loaded chunks: walks the store's columns directly and
+    // fills the day buckets and balance steps (the summary already covers
+    // categories and months). Large chunks are split across the global
+    // thread pool and merged in row order, so the result matches a serial
+    // pass exactly.
+    void addTransactions(const TransactionStore& store, int first, int count);
+
+    // Expense totals keyed by category id
+    const QMap<int, CategoryTotal>& categoryTotals() const { return categories; }
+    // Income/expense totals of every non-empty period, oldest first. Rolled
+    // up on demand from the per-day or per-month array.
+    QVector<Period> periodTotals(DateBucket::Granularity granularity) const;
+
+    // Running balance, one point per distinct timestamp, from the earliest
+    // step changed since the last call to the end. Returns false when no step
+    // changed; otherwise *from is that step's time and the points before it
+    // still hold, so the chart only rewrites what follows.
+    bool takeBalanceChanges(qint64 *from, QList<QPointF> *points);
+
+private:
+    struct BalanceStep {
+        Money delta;
+        int count = 0;
+    };
+
+    // Totals indexed by an integer period key minus first
+    struct Buckets {
+        qint64 first = 0;
+        QVector<PeriodTotal> totals;
+
+        PeriodTotal& at(qint64 key) { return totals[int(key - first)]; }
+        // Grows the array to cover the keys [from, to]
+        void reserve(qint64 from, qint64 to);
+        // Drops empty buckets at both ends after a removal
+        void trim();
+    };
+
+    // Aggregates of one row range, built on a worker thread
+    struct Partial;
+
+    static Partial aggregate(const TransactionStore& store, int first, int count);
+    void merge(const Partial& partial);
+    void apply(const Transaction& transaction, int direction);
+    void markBalanceChanged(qint64 timestamp);
+
+    QMap<int, CategoryTotal> categories;
+    Buckets months;  // Keyed by DateBucket::Month
+    Buckets days;    // Keyed by julian day
+    QMap<qint64, BalanceStep> balanceSteps;
+    Money balance;  // Sum of every step
+    bool balanceChanged = true;
+    qint64 balanceChangedFrom = std::numeric_limits<qint64>::min();
+};
+
+#endif // ANALYTICSSTORE_H
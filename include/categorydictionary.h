@@ -0,0 +1,35 @@
+#ifndef CATEGORYDICTIONARY_H
+#define CATEGORYDICTIONARY_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// In-memory copy of the categories table. Transactions refer to categories
+// by their integer id, so filtering and grouping compare small integers and
+// names are only looked up for display.
+class CategoryDictionary
+{
+public:
+    void clear();
+    void insert(int id, const QString& name);
+
+    bool contains(int id) const { return id >= 0 && id < names.size() && !names.at(id).isNull(); }
+    // -1 if no category has that name
+    int id(const QString& name) const { return ids.value(name, -1); }
+    QString name(int id) const { return contains(id) ? names.at(id) : QString(); }
+
+    // Ids in the order the categories were created
+    const QVector<int>& categoryIds() const { return order; }
+    QStringList categoryNames() const;
+    // One past the largest id, for arrays indexed by category id
+    int idLimit() const { return names.size(); }
+
+private:
+    QVector<QString> names;  // Indexed by id; null for unused ids
+    QHash<QString, int> ids;
+    QVector<int> order;
+};
+
+#endif // CATEGORYDICTIONARY_H
@@ -0,0 +1,57 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QStringList>
+
+#include "storageprofile.h"
+
+class QThread;
+
+// Named SQLite connections to one database file. The main writer is owned by
+// the thread that creates and opens the pool; every other thread gets its own
+// connection, so each works on a connection it created itself. In WAL mode
+// the readers never block the writers or each other. A thread that batches
+// writes in the background may open a writer of its own; SQLite serializes it
+// with the main writer through the busy timeout.
+class ConnectionPool
+{
+public:
+    ConnectionPool();
+    ~ConnectionPool();
+
+    // Must be called on the thread that created the pool
+    bool open(const QString& databasePath, const StorageProfile& profile);
+    // Closes every connection
+    void close();
+    bool isOpen() const { return writerConnection.isOpen(); }
+    QString databasePath() const { return path; }
+
+    // The write connection; only to be used on the writer thread
+    QSqlDatabase writer() const { return writerConnection; }
+    // The calling thread's read-only connection, opened on first use
+    QSqlDatabase reader() { return threadConnection(true); }
+    // Closes the calling thread's reader; threads that end before the pool
+    // closes call this on their way out
+    void releaseReader() { releaseThreadConnection(true); }
+    // The same for a background writer on the calling thread
+    QSqlDatabase backgroundWriter() { return threadConnection(false); }
+    void releaseBackgroundWriter() { releaseThreadConnection(false); }
+
+private:
+    QString threadConnectionName(bool readOnly) const;
+    QSqlDatabase threadConnection(bool readOnly);
+    void releaseThreadConnection(bool readOnly);
+
+    QString path;
+    StorageProfile profile;
+    QString prefix;
+    QSqlDatabase writerConnection;
+    QThread *ownerThread;           // Created the pool; owns the writer
+
+    QMutex mutex;
+    QStringList threadConnectionNames;  // Guarded by mutex
+};
+
+#endif // CONNECTIONPOOL_H
@@ -0,0 +1,45 @@
+#ifndef CSVEXPORTER_H
+#define CSVEXPORTER_H
+
+#include <QByteArray>
+#include <QStringView>
+
+#include "exportworker.h"
+#include "databasemanager.h"
+
+// Streams the rows matching a filter from a SQLite cursor straight into a
+// CSV file. Fields are encoded into one large output buffer, so memory stays
+// flat whatever the row count.
+class CsvExporter : public ExportWorker
+{
+    Q_OBJECT
+
+public:
+    CsvExporter(ConnectionPool *connections, const QString& fileName,
+                const TransactionFilter& filter, bool useFullTextSearch, QObject *parent = nullptr);
+
+protected:
+    bool exportData(QSqlDatabase& db, QString *message, QString *error) override;
+
+private:
+    static const int BufferSize = 1 << 20;
+    static const int ProgressInterval = 10000;
+
+    static void appendText(QByteArray& buffer, QStringView text);
+    static void appendQuoted(QByteArray& buffer, QStringView text);
+    static void appendAmount(QByteArray& buffer, qint64 cents);
+    static void appendDigits(QByteArray& buffer, int value, int width);
+    // Local "yyyy-MM-dd hh:mm" of an epoch-ms time
+    void appendDateTime(QByteArray& buffer, qint64 msecs);
+
+    QString fileName;
+    TransactionFilter filter;
+    bool useFullTextSearch;
+
+    // Local day of the previous row and its "yyyy-MM-dd " text
+    qint64 dayStart = 1;  // Empty range until the first row
+    qint64 dayEnd = 0;
+    QByteArray dayText;
+};
+
+#endif // CSVEXPORTER_H
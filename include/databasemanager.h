@@ -0,0 +1,138 @@
+#ifndef DATABASEMANAGER_H
+#define DATABASEMANAGER_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QVector>
+#include <QDate>
+#include <functional>
+
+#include "transaction.h"
+#include "categorydictionary.h"
+#include "connectionpool.h"
+#include "statementcache.h"
+
+// Criteria for DatabaseManager::prepareFilterQuery(), run by the search
+// worker. Unset fields do not constrain the result.
+struct TransactionFilter
+{
+    QString searchText;        // Matched against description and category name
+    int categoryId = -1;       // -1 means all categories
+    bool hasMinAmount = false;
+    Money minAmount;           // Absolute amount
+    bool hasMaxAmount = false;
+    Money maxAmount;           // Absolute amount
+    QDate startDate;           // Invalid means unbounded
+    QDate endDate;             // Inclusive
+
+    bool isEmpty() const
+    {
+        return searchText.isEmpty() && categoryId < 0 && !hasMinAmount && !hasMaxAmount
+               && !startDate.isValid() && !endDate.isValid();
+    }
+};
+
+// One row of the transaction_summary table: the absolute total and count of
+// one type of transaction in one category and local calendar month
+struct TransactionSummary
+{
+    int monthKey = 0;          // year * 12 + month - 1, as DateBucket::Month
+    int categoryId = -1;
+    Transaction::Type type = Transaction::Income;
+    Money total;
+    int count = 0;
+};
+
+class DatabaseManager
+{
+public:
+    // Schema written by this build; PRAGMA user_version holds the on-disk one
+    static constexpr int SchemaVersion = 5;
+    // Rows copied per committed chunk when a migration rebuilds the table;
+    // an interrupted run resumes after the last committed chunk
+    static constexpr int MigrationChunkSize = 50000;
+
+    // Receives a description of the running migration step and the rows
+    // copied so far out of total
+    using MigrationProgress = std::function<void(const QString& step, int done, int total)>;
+
+    DatabaseManager() = default;
+    ~DatabaseManager();
+
+    // Opens the database and upgrades older schemas step by step
+    bool initialize(const MigrationProgress& progress = nullptr);
+    // Same, for a database file other than databasePath()
+    bool initialize(const QString& dbPath, const MigrationProgress& progress = nullptr);
+    static QString databasePath();
+    // Named per-thread connections for the worker threads
+    ConnectionPool& connections() { return pool; }
+    // Prepared statements of the writer connection, with hit/miss counts
+    const StatementCache& statementCache() const { return statements; }
+    bool hasFullTextSearch() const { return ftsAvailable; }
+
+    // Category names by id, loaded at startup and kept in step with the
+    // categories table
+    const CategoryDictionary& categories() const { return categoryDictionary; }
+    // Id of the named category, creating it first if it is new; -1 on error
+    int categoryId(const QString& name);
+
+    // Bulk import in committed chunks; progress receives the number of rows
+    // written so far and may return false to stop after the current chunk.
+    // Returns the number of rows committed.
+    int addTransactions(const QVector<Transaction>& transactions,
+                        const std::function<bool(int)>& progress = nullptr);
+    // Edits many rows in a single SQL transaction; single inserts and
+    // deletes go through the WriteBehindQueue
+    bool updateTransactions(const QVector<Transaction>& transactions);
+
+    // Exact integer sums, read from the summary table so their cost does not
+    // grow with the number of transactions
+    Money getTotalBalance();
+    Money getTotalIncome();
+    Money getTotalExpenses();
+    // Every non-empty (month, category, type) total, oldest month first
+    QVector<TransactionSummary> getSummary();
+
+    // Shared with the worker threads, which run the same queries on their
+    // own connections. A non-empty sortOrder replaces the default ordering.
+    static bool prepareFilterQuery(QSqlQuery& query, const TransactionFilter& filter, bool useFullTextSearch,
+                                   const QString& sortOrder = QString());
+    static Transaction transactionFromQuery(const QSqlQuery& query);
+
+private:
+    static constexpr int BulkInsertChunkSize = 10000;
+
+    // One schema upgrade. Steps that reshape transactions copy it into
+    // transactions_migrated in chunks and then swap the tables.
+    struct Migration {
+        int version;           // user_version once the step has run
+        QString description;
+        QStringList prepare;   // Run first, in one transaction; must be idempotent
+        QString createTable;   // CREATE TABLE IF NOT EXISTS transactions_migrated, or empty
+        QString copyRows;      // INSERT ... SELECT with :lastId and :limit, keyed on id
+        QStringList finish;    // Run with the table swap, after the rename
+    };
+    static QVector<Migration> migrations();
+
+    bool createTables(const MigrationProgress& progress);
+    bool hasTable(const QString& table);
+    bool hasColumn(const QString& table, const QString& column);
+    int schemaVersion();
+    int unversionedSchemaVersion();
+    bool migrate(const MigrationProgress& progress);
+    bool runMigration(const Migration& migration, const MigrationProgress& progress);
+    bool runInTransaction(const QStringList& statements);
+    bool loadCategories();
+    bool createSearchIndex();
+    bool createSummaryTriggers();
+    Money summaryTotal(const QString& sql);
+
+    ConnectionPool pool;
+    QSqlDatabase db;           // The pool's writer
+    StatementCache statements;
+    bool ftsAvailable = false;
+    CategoryDictionary categoryDictionary;
+};
+
+#endif // DATABASEMANAGER_H
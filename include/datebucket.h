@@ -0,0 +1,52 @@
+#ifndef DATEBUCKET_H
+#define DATEBUCKET_H
+
+#include <QDate>
+#include <QString>
+#include <QtGlobal>
+
+// Integer keys for calendar periods. Rows are bucketed by comparing and
+// indexing integers instead of formatting dates, and consecutive periods
+// have consecutive keys, so a key range maps straight onto a dense array.
+class DateBucket
+{
+public:
+    enum Granularity {
+        Day,
+        Week,
+        Month,
+        Quarter,
+        Year
+    };
+
+    // Key of the period that contains a day given as QDate::toJulianDay()
+    static qint64 key(Granularity granularity, qint64 julianDay);
+    // Month, quarter or year key of the period containing a month key
+    static qint64 keyFromMonth(Granularity granularity, qint64 monthKey);
+    static QDate periodStart(Granularity granularity, qint64 key);
+    // Axis label: "2024-03-15", "2024-W11", "2024-03", "2024 Q1", "2024"
+    static QString label(Granularity granularity, qint64 key);
+    static QString name(Granularity granularity);
+};
+
+// Maps epoch-ms timestamps to local julian days. The bounds of the last day
+// are remembered, so time-ordered rows usually cost two compares.
+class DayKeyCache
+{
+public:
+    qint64 dayOf(qint64 msecs)
+    {
+        if (msecs < dayStart || msecs >= dayEnd)
+            load(msecs);
+        return day;
+    }
+
+private:
+    void load(qint64 msecs);
+
+    qint64 dayStart = 1;  // Empty range until the first lookup
+    qint64 dayEnd = 0;
+    qint64 day = 0;
+};
+
+#endif // DATEBUCKET_H
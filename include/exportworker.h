@@ -0,0 +1,42 @@
+#ifndef EXPORTWORKER_H
+#define EXPORTWORKER_H
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QString>
+#include <atomic>
+
+#include "connectionpool.h"
+
+// Base for exporters that run on their own thread and read the database
+// through its own pool reader. Subclasses implement exportData() and call
+// reportProgress() as rows are written; cancel() may be called from any
+// thread and is honoured at the next check of isCancelled().
+class ExportWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ExportWorker(ConnectionPool *connections, QObject *parent = nullptr);
+
+    void cancel();
+    bool isCancelled() const;
+
+public slots:
+    void run();
+
+signals:
+    void progressChanged(int rows);
+    void finished(bool success, const QString& message);
+
+protected:
+    // Returns false and sets *error on failure; *message is shown on success
+    virtual bool exportData(QSqlDatabase& db, QString *message, QString *error) = 0;
+    void reportProgress(int rows);
+
+private:
+    ConnectionPool *connections;
+    std::atomic<bool> cancelled;
+};
+
+#endif // EXPORTWORKER_H
@@ -0,0 +1,52 @@
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <QString>
+#include <QtGlobal>
+#include <cmath>
+
+// Fixed-point amount in whole cents. Sums and differences are exact integer
+// arithmetic, so running totals never drift however many transactions are
+// added and removed. Conversion to double is only for display and charts.
+class Money
+{
+public:
+    constexpr Money() = default;
+
+    static constexpr Money fromCents(qint64 cents) { return Money(cents); }
+    // Rounds to the nearest cent
+    static Money fromDouble(double amount) { return Money(std::llround(amount * 100.0)); }
+    // Parses "1234", "-12.5", "1,234.56" and "$12.30" without going through
+    // a double; more than two decimals is an error
+    static Money fromString(const QString& text, bool *ok = nullptr);
+
+    constexpr qint64 cents() const { return value; }
+    double toDouble() const { return value / 100.0; }
+    // Plain "-1234.56", the format the exporters and the table use
+    QString toString() const;
+
+    constexpr Money abs() const { return Money(value < 0 ? -value : value); }
+    constexpr bool isNegative() const { return value < 0; }
+    constexpr bool isZero() const { return value == 0; }
+
+    constexpr Money operator-() const { return Money(-value); }
+    constexpr Money operator+(Money other) const { return Money(value + other.value); }
+    constexpr Money operator-(Money other) const { return Money(value - other.value); }
+    constexpr Money operator*(qint64 factor) const { return Money(value * factor); }
+    constexpr Money& operator+=(Money other) { value += other.value; return *this; }
+    constexpr Money& operator-=(Money other) { value -= other.value; return *this; }
+
+    constexpr bool operator==(Money other) const { return value == other.value; }
+    constexpr bool operator!=(Money other) const { return value != other.value; }
+    constexpr bool operator<(Money other) const { return value < other.value; }
+    constexpr bool operator<=(Money other) const { return value <= other.value; }
+    constexpr bool operator>(Money other) const { return value > other.value; }
+    constexpr bool operator>=(Money other) const { return value >= other.value; }
+
+private:
+    constexpr explicit Money(qint64 cents) : value(cents) {}
+
+    qint64 value = 0;
+};
+
+#endif // MONEY_H
@@ -0,0 +1,44 @@
+#ifndef PDFREPORTRENDERER_H
+#define PDFREPORTRENDERER_H
+
+#include "exportworker.h"
+#include "databasemanager.h"
+
+class QPainter;
+class QRectF;
+
+// Paints the transaction report straight onto a PDF QPrinter, one page at a
+// time, while stepping through a SQLite cursor. Only the current page is
+// ever held in memory, and each page closes with its own subtotals.
+class PdfReportRenderer : public ExportWorker
+{
+    Q_OBJECT
+
+public:
+    struct Summary {
+        Money totalIncome;
+        Money totalExpenses;
+        Money currentBalance;
+    };
+
+    PdfReportRenderer(ConnectionPool *connections, const QString& fileName,
+                      const TransactionFilter& filter, bool useFullTextSearch,
+                      const Summary& summary, QObject *parent = nullptr);
+
+protected:
+    bool exportData(QSqlDatabase& db, QString *message, QString *error) override;
+
+private:
+    static const int ProgressInterval = 1000;
+
+    qreal drawTableHeader(QPainter& painter, const QRectF& pageRect, qreal top, qreal rowHeight);
+    void drawPageFooter(QPainter& painter, const QRectF& pageRect, qreal rowHeight, int page,
+                        Money pageIncome, Money pageExpenses);
+
+    QString fileName;
+    TransactionFilter filter;
+    bool useFullTextSearch;
+    Summary summary;
+};
+
+#endif // PDFREPORTRENDERER_H
@@ -0,0 +1,45 @@
+#ifndef SEARCHWORKER_H
+#define SEARCHWORKER_H
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QVector>
+#include <atomic>
+
+#include "transaction.h"
+#include "connectionpool.h"
+#include "databasemanager.h"
+
+// Runs filter queries on its own thread and SQLite connection. Results are
+// handed back in batches tagged with the generation of the request, and a
+// newer request makes any older one stop at the next row.
+class SearchWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SearchWorker(ConnectionPool *connections, bool useFullTextSearch, QObject *parent = nullptr);
+    ~SearchWorker();
+
+    // Thread-safe; called from the GUI thread before queueing a new search
+    void cancelBefore(quint64 generation);
+
+public slots:
+    void search(quint64 generation, const TransactionFilter& filter);
+
+signals:
+    void resultsReady(quint64 generation, const QVector<Transaction>& batch);
+
+private:
+    bool openConnection();
+    bool isCancelled(quint64 generation) const;
+
+    static const int BatchSize = 500;
+
+    ConnectionPool *connections;
+    bool useFullTextSearch;
+    QSqlDatabase db;
+    std::atomic<quint64> latestGeneration;
+};
+
+#endif // SEARCHWORKER_H
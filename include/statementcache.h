@@ -0,0 +1,48 @@
+#ifndef STATEMENTCACHE_H
+#define STATEMENTCACHE_H
+
+#include <QCache>
+#include <QLoggingCategory>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+
+// Hit/miss counts at shutdown; enable with
+// QT_LOGGING_RULES="financetracker.statementcache.debug=true"
+Q_DECLARE_LOGGING_CATEGORY(lcStatementCache)
+
+// Prepared queries for one connection, keyed by their SQL text. A hit hands
+// back the statement SQLite already parsed and planned; only the bound
+// values change. Statements with SQL built per call (filters, migrations)
+// should not go through the cache, or they would push out the fixed ones.
+class StatementCache
+{
+public:
+    explicit StatementCache(int capacity = DefaultCapacity);
+    ~StatementCache();
+
+    // Drops every cached statement; they belong to the previous connection
+    void setDatabase(const QSqlDatabase& db);
+    void clear();
+
+    // The prepared query for sql, reset and ready for new bind values, or
+    // nullptr if it does not prepare. Valid until the next call. Callers
+    // finish() queries whose results they stop reading early.
+    QSqlQuery *prepare(const QString& sql);
+
+    quint64 hits() const { return hitCount; }
+    quint64 misses() const { return missCount; }
+    int size() const { return queries.size(); }
+    // Logs the counts under lcStatementCache, labelled with the connection
+    void logStatistics(const char *connection) const;
+
+private:
+    static const int DefaultCapacity = 32;
+
+    QSqlDatabase db;
+    QCache<QString, QSqlQuery> queries;
+    quint64 hitCount = 0;
+    quint64 missCount = 0;
+};
+
+#endif // STATEMENTCACHE_H
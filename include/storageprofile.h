@@ -0,0 +1,45 @@
+#ifndef STORAGEPROFILE_H
+#define STORAGEPROFILE_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+
+// SQLite tuning applied to every connection the application opens. The
+// profile is read from finance_tracker.ini next to the database, so each
+// deployment can trade durability for speed without a rebuild:
+//
+//   [storage]
+//   profile=balanced        ; safe, balanced or fast; keys below override it
+//   journal_mode=WAL
+//   synchronous=NORMAL
+//   cache_size_kib=65536
+//   mmap_size_mib=256
+//   temp_store=MEMORY
+//   busy_timeout_ms=5000
+struct StorageProfile
+{
+    QString name = "balanced";
+    QString journalMode = "WAL";      // WAL lets worker threads read while the GUI writes
+    QString synchronous = "NORMAL";
+    int cacheSizeKiB = 65536;
+    int mmapSizeMiB = 256;
+    QString tempStore = "MEMORY";
+    int busyTimeoutMs = 5000;         // How long a connection waits on a lock
+
+    // safe: the SQLite defaults the application used to run with.
+    // balanced: WAL with NORMAL sync; a power cut can lose the last
+    // commits but never corrupts the file. fast: no fsync at all.
+    static StorageProfile preset(const QString& name, bool *ok = nullptr);
+    static StorageProfile load(const QString& path = configPath());
+    static QString configPath();
+
+    // QSQLITE connect options, to be set before open()
+    QString connectOptions(bool readOnly) const;
+    // PRAGMAs run right after open(). Read-only connections skip
+    // journal_mode, which is a property of the database file.
+    QStringList pragmas(bool readOnly) const;
+    bool apply(QSqlDatabase& db, bool readOnly) const;
+};
+
+#endif // STORAGEPROFILE_H
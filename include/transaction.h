@@ -0,0 +1,54 @@
+#ifndef TRANSACTION_H
+#define TRANSACTION_H
+
+#include <QString>
+#include <QDateTime>
+
+#include "datebucket.h"
+#include "money.h"
+
+class Transaction
+{
+public:
+    enum Type {
+        Income,
+        Expense
+    };
+
+    Transaction() = default;
+    Transaction(Type type, Money amount, const QString& description,
+                int categoryId, const QDateTime& datetime, qint64 id = -1)
+        : m_id(id)
+        , m_type(type)
+        , m_amount(amount)
+        , m_description(description)
+        , m_categoryId(categoryId)
+        , m_datetime(datetime)
+    {
+    }
+
+    // SQLite row id; -1 until the transaction has been saved
+    qint64 id() const { return m_id; }
+    void setId(qint64 id) { m_id = id; }
+
+    Type type() const { return m_type; }
+    // Signed: expenses are negative
+    Money amount() const { return m_amount; }
+    QString description() const { return m_description; }
+    // Id in the categories table; names come from DatabaseManager::categories()
+    int categoryId() const { return m_categoryId; }
+    QDateTime datetime() const { return m_datetime; }
+    // Local calendar month as DateBucket::Month, stored with the row so the
+    // summary keeps its buckets when the system time zone changes
+    qint64 monthKey() const { return DateBucket::key(DateBucket::Month, m_datetime.date().toJulianDay()); }
+
+private:
+    qint64 m_id = -1;
+    Type m_type = Income;
+    Money m_amount;
+    QString m_description;
+    int m_categoryId = -1;
+    QDateTime m_datetime;
+};
+
+#endif // TRANSACTION_H
@@ -0,0 +1,45 @@
+#ifndef TRANSACTIONIMPORTER_H
+#define TRANSACTIONIMPORTER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "transaction.h"
+#include "databasemanager.h"
+
+class QTextStream;
+
+// Reads bank statements into transactions ready for
+// DatabaseManager::addTransactions(). CSV files need a header row naming
+// at least a date and an amount column; the layout written by
+// "Export to CSV" is accepted as is. OFX/QFX files are read from their
+// STMTTRN records. Category names are resolved to ids through the database,
+// which creates any category it has not seen before.
+class TransactionImporter
+{
+public:
+    explicit TransactionImporter(DatabaseManager& database) : database(database) {}
+
+    bool readFile(const QString& fileName);
+
+    const QVector<Transaction>& transactions() const { return importedTransactions; }
+    int skippedRecords() const { return skipped; }
+    QString errorString() const { return error; }
+
+private:
+    bool readCsv(QTextStream& in);
+    bool readOfx(QTextStream& in);
+
+    static bool readCsvRecord(QTextStream& in, QStringList& fields);
+    static Money parseAmount(const QString& text, bool *ok);
+    static QDateTime parseDate(const QString& text);
+    static QDateTime parseOfxDate(const QString& text);
+
+    DatabaseManager& database;
+    QVector<Transaction> importedTransactions;
+    int skipped = 0;
+    QString error;
+};
+
+#endif // TRANSACTIONIMPORTER_H
@@ -0,0 +1,45 @@
+#ifndef TRANSACTIONLOADER_H
+#define TRANSACTIONLOADER_H
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QVector>
+#include <atomic>
+
+#include "transaction.h"
+#include "connectionpool.h"
+
+// Streams the transactions table, newest first, on its own thread and SQLite
+// connection. The first chunk is small so the table paints right away; each
+// chunk is a separate keyset query so no read lock is held between chunks.
+class TransactionLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TransactionLoader(ConnectionPool *connections, QObject *parent = nullptr);
+    ~TransactionLoader();
+
+    // Thread-safe; a load older than generation stops at the next chunk
+    void cancelBefore(quint64 generation);
+
+public slots:
+    void load(quint64 generation);
+
+signals:
+    void transactionsLoaded(quint64 generation, const QVector<Transaction>& chunk);
+    void loadingFinished(quint64 generation);
+
+private:
+    bool openConnection();
+    bool isCancelled(quint64 generation) const;
+
+    static const int FirstChunkSize = 200;
+    static const int ChunkSize = 5000;
+
+    ConnectionPool *connections;
+    QSqlDatabase db;
+    std::atomic<quint64> latestGeneration;
+};
+
+#endif // TRANSACTIONLOADER_H
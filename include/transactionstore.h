@@ -0,0 +1,73 @@
+#ifndef TRANSACTIONSTORE_H
+#define TRANSACTIONSTORE_H
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+#include "transaction.h"
+#include "categorydictionary.h"
+
+// Column-wise storage for the transactions held in memory. Each field lives
+// in its own array: epoch-ms timestamps, signed amounts in cents, the type,
+// and the category id. All descriptions share one string arena that
+// rows point into. Loops over a single column stay cache friendly, and a row
+// costs a few dozen bytes plus its description text, instead of two QStrings
+// and a QDateTime.
+class TransactionStore
+{
+public:
+    // Category names are looked up in the given dictionary
+    explicit TransactionStore(const CategoryDictionary *categories) : categoryDictionary(categories) {}
+
+    int size() const { return ids.size(); }
+    bool isEmpty() const { return ids.isEmpty(); }
+    void clear();
+    void reserve(int count);
+
+    void append(const Transaction& transaction);
+    void append(const QVector<Transaction>& transactions);
+    void replace(int row, const Transaction& transaction);
+    // Leaves the description text behind for the next truncate() or
+    // replace() to reclaim; remove many rows with move() and truncate()
+    void remove(int row);
+
+    // For in-place compaction: copy row `from` over row `to`, then cut the
+    // store down with truncate()
+    void move(int from, int to);
+    void truncate(int count);
+
+    // Rebuilds a Transaction for callers that need a whole row
+    Transaction at(int row) const;
+
+    qint64 id(int row) const { return ids.at(row); }
+    qint64 timestamp(int row) const { return timestampColumn.at(row); }
+    qint64 cents(int row) const { return centsColumn.at(row); }
+    Transaction::Type type(int row) const { return Transaction::Type(typeColumn.at(row)); }
+    int categoryId(int row) const { return categoryColumn.at(row); }
+    QString category(int row) const { return categoryDictionary->name(categoryColumn.at(row)); }
+    QStringView description(int row) const;
+
+    // Whole columns for aggregation loops
+    const QVector<qint64>& timestamps() const { return timestampColumn; }
+    const QVector<qint64>& amounts() const { return centsColumn; }
+    const QVector<quint8>& types() const { return typeColumn; }
+    const QVector<int>& categories() const { return categoryColumn; }
+
+private:
+    quint32 storeDescription(const QString& text);
+    void compactDescriptions();
+
+    QVector<qint64> ids;
+    QVector<qint64> timestampColumn;
+    QVector<qint64> centsColumn;
+    QVector<quint8> typeColumn;
+    QVector<int> categoryColumn;
+    QVector<quint32> descriptionStart;
+    QVector<quint32> descriptionLength;
+
+    QString descriptionArena;
+    const CategoryDictionary *categoryDictionary;
+};
+
+#endif // TRANSACTIONSTORE_H
@@ -0,0 +1,54 @@
+#ifndef TRANSACTIONTABLEMODEL_H
+#define TRANSACTIONTABLEMODEL_H
+
+#include <QAbstractTableModel>
+
+#include "transactionstore.h"
+
+// Table model that reads straight from a transaction store owned elsewhere.
+// Cells are formatted on demand in data(), so the view only ever touches the
+// rows that are actually visible.
+class TransactionTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        TypeColumn,
+        AmountColumn,
+        DescriptionColumn,
+        CategoryColumn,
+        DateTimeColumn,
+        ColumnCount
+    };
+
+    explicit TransactionTableModel(const TransactionStore *transactions, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    Transaction transactionAt(int row) const;
+
+    // Point the model at another store; call between
+    // beginResetTransactions() and endResetTransactions()
+    void setTransactions(const TransactionStore *transactions);
+    void refresh();
+
+    // The owner mutates the store between each begin/end pair so the view
+    // only has to process the affected rows.
+    void beginAppendTransactions(int count);
+    void endAppendTransactions();
+    void beginRemoveTransaction(int row);
+    void endRemoveTransaction();
+    void beginResetTransactions();
+    void endResetTransactions();
+    // Rows first..last were edited in place
+    void rowsChanged(int first, int last);
+
+private:
+    const TransactionStore *transactions;
+};
+
+#endif // TRANSACTIONTABLEMODEL_H
@@ -0,0 +1,81 @@
+#ifndef WRITEBEHINDQUEUE_H
+#define WRITEBEHINDQUEUE_H
+
+#include <QFile>
+#include <QObject>
+#include <QSqlDatabase>
+#include <QTimer>
+#include <QVector>
+#include <atomic>
+
+#include "transaction.h"
+#include "connectionpool.h"
+#include "statementcache.h"
+
+// Inserts and deletes from the form, written behind the model on their own
+// thread. Each change is appended to a journal file next to the database,
+// which is synced to disk once per burst, and changes are committed to
+// SQLite together once CommitIntervalMs has passed or CommitRows are
+// pending. The journal is emptied after every commit; whatever it still
+// holds at startup was not committed and is replayed by recover().
+//
+// New rows get their id from reserveId() up front, so the model can show
+// them at once and a replay can tell which rows already made it.
+class WriteBehindQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    WriteBehindQueue(ConnectionPool *connections, const QString& journalPath, QObject *parent = nullptr);
+    ~WriteBehindQueue();
+
+    // The methods below are called from the GUI thread once the queue has
+    // been moved to its own thread. recover() and flush() block until the
+    // queue thread is done.
+
+    // Replays the journal of a previous run; returns the number of changes
+    int recover();
+    qint64 reserveId();
+    void insert(const Transaction& transaction);
+    void remove(const QVector<Transaction>& transactions);
+    // Commits everything queued so far. Called before anything else reads
+    // or writes the transactions table, so it sees the same rows as the model.
+    void flush();
+
+signals:
+    // Changes that could not be committed; the model should undo them
+    void writesFailed(const QVector<Transaction>& inserted, const QVector<Transaction>& removed,
+                      const QString& error);
+
+private:
+    struct Operation {
+        bool insert = true;
+        Transaction transaction;
+    };
+
+    // Run on the queue thread
+    bool openConnection();
+    void enqueue(const QVector<Operation>& operations);
+    void syncJournal();
+    void commitPending();
+    bool apply(const QVector<Operation>& operations, bool replay, QString *error);
+    void clearJournal();
+    void updateNextId();
+
+    static QByteArray encode(const Operation& operation);
+    static bool decode(const QByteArray& line, Operation *operation);
+
+    static const int CommitIntervalMs = 200;
+    static const int CommitRows = 500;
+
+    ConnectionPool *connections;
+    QFile journal;
+    QSqlDatabase db;
+    StatementCache statements;
+    QVector<Operation> pending;
+    QTimer *commitTimer;
+    QTimer *syncTimer;
+    std::atomic<qint64> nextId;
+};
+
+#endif // WRITEBEHINDQUEUE_H
@@ -0,0 +1,59 @@
+#ifndef XLSXEXPORTER_H
+#define XLSXEXPORTER_H
+
+#include <QByteArray>
+#include <QStringList>
+#include <QStringView>
+
+#include "exportworker.h"
+#include "databasemanager.h"
+#include "zipstreamwriter.h"
+
+// Streams the rows matching a filter into an XLSX workbook with one sheet
+// per month or per category. Dates and amounts are written as typed cells;
+// strings are inline so no shared string table has to be kept in memory.
+// A group that outgrows Excel's row limit continues on further sheets.
+class XlsxExporter : public ExportWorker
+{
+    Q_OBJECT
+
+public:
+    enum Grouping {
+        ByMonth,
+        ByCategory
+    };
+
+    XlsxExporter(ConnectionPool *connections, const QString& fileName,
+                 const TransactionFilter& filter, bool useFullTextSearch,
+                 Grouping grouping, QObject *parent = nullptr);
+
+protected:
+    bool exportData(QSqlDatabase& db, QString *message, QString *error) override;
+
+private:
+    static const int BufferSize = 1 << 18;
+    static const int ProgressInterval = 10000;
+    // Excel allows 1,048,576 rows per sheet, one of which is the header
+    static const int MaxRowsPerSheet = 1048575;
+
+    bool beginSheet(ZipStreamWriter& zip, const QString& group);
+    bool endSheet(ZipStreamWriter& zip);
+    bool flush(ZipStreamWriter& zip);
+    bool writeEntry(ZipStreamWriter& zip, const QString& name, const QByteArray& data);
+    bool writeWorkbookParts(ZipStreamWriter& zip);
+    QString uniqueSheetName(const QString& group) const;
+
+    static void appendEscaped(QByteArray& buffer, QStringView text);
+    static void appendInlineString(QByteArray& buffer, QStringView text);
+
+    QString fileName;
+    TransactionFilter filter;
+    bool useFullTextSearch;
+    Grouping grouping;
+
+    QStringList sheetNames;
+    QByteArray buffer;
+    int sheetRows = 0;
+};
+
+#endif // XLSXEXPORTER_H
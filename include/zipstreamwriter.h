@@ -0,0 +1,65 @@
+#ifndef ZIPSTREAMWRITER_H
+#define ZIPSTREAMWRITER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// Minimal forward-only ZIP writer. Entry data is compressed and written as
+// it arrives (sizes and CRC follow in a data descriptor), so an entry of any
+// length never has to be held in memory. Without zlib, entries are stored.
+// There are no ZIP64 records: an archive whose sizes or offsets pass 4 GB,
+// or that has more than 65535 entries, fails instead of wrapping.
+class ZipStreamWriter
+{
+public:
+    explicit ZipStreamWriter(const QString& fileName);
+    ~ZipStreamWriter();
+
+    bool open();
+    bool beginEntry(const QString& name);
+    bool write(const QByteArray& data);
+    bool endEntry();
+    bool close();
+    // Abandons the archive and deletes the partial file
+    void discard();
+
+    QString errorString() const { return error; }
+
+private:
+    struct Entry {
+        QByteArray name;
+        quint32 crc = 0;
+        qint64 compressedSize = 0;
+        qint64 uncompressedSize = 0;
+        qint64 offset = 0;
+        quint16 method = 0;
+    };
+
+    bool writeRaw(const char *data, qint64 size);
+    // False, with the error set, once a 32-bit ZIP field would overflow
+    bool fitsZip32(qint64 value);
+    void appendLE16(QByteArray& out, quint16 value);
+    void appendLE32(QByteArray& out, quint32 value);
+    static quint32 updateCrc(quint32 crc, const char *data, qint64 size);
+
+    QFile file;
+    QVector<Entry> entries;
+    Entry current;
+    bool inEntry = false;
+    quint16 dosTime = 0;
+    quint16 dosDate = 0;
+    QString error;
+
+#ifdef HAVE_ZLIB
+    z_stream stream;
+    QByteArray deflateBuffer;
+#endif
+};
+
+#endif // ZIPSTREAMWRITER_H
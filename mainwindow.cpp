@@ -12,12 +12,17 @@
 #include <QGridLayout>
 #include <QPrinter>
 #include <QPainter>
-#include <QTextDocument>
 #include <QShortcut>
 #include <QMenuBar>
 #include <QGroupBox>
 #include <QScrollArea>
 #include <QScreen>
+#include <QTimer>
+#include <QProgressDialog>
+#include <QInputDialog>
+#include <QStatusBar>
+#include <QSet>
+#include <algorithm>
 #include <cmath>
 
 #include <QtCharts/QChart>
@@ -34,15 +39,28 @@
 QT_USE_NAMESPACE
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
-    , currentBalance(0.0)
-    , totalIncome(0.0)
-    , totalExpenses(0.0)
+    , transactions(&dbManager.categories())
+    , filteredTransactions(&dbManager.categories())
 {
-    // Initialize database
-    if (!dbManager.initialize()) {
+    // Initialize database. Upgrading an old database copies it in chunks;
+    // the modal dialog keeps events flowing between them.
+    QProgressDialog migrationProgress("Upgrading database...", QString(), 0, 0, this);
+    migrationProgress.setWindowModality(Qt::WindowModal);
+    migrationProgress.setMinimumDuration(500);
+    migrationProgress.setCancelButton(nullptr);
+    bool databaseReady = dbManager.initialize([&migrationProgress](const QString& step, int done, int total) {
+        migrationProgress.setLabelText(step + "...");
+        migrationProgress.setMaximum(qMax(total, 1));
+        migrationProgress.setValue(qMin(done, migrationProgress.maximum()));
+    });
+    migrationProgress.reset();
+    if (!databaseReady) {
         QMessageBox::critical(this, "Error", "Failed to initialize database!");
     }
 
+    // Start the background loader and search threads
+    setupWorkers();
+
     // Setup UI
     setupUI();
 
@@ -52,33 +70,172 @@ MainWindow::MainWindow(QWidget *parent)
 MainWindow::~MainWindow()
 {    cleanupCharts();
 
+    transactionLoader->cancelBefore(++loadGeneration);
+    searchWorker->cancelBefore(++searchGeneration);
+    loaderThread->quit();
+    searchThread->quit();
+    loaderThread->wait();
+    searchThread->wait();
+
+    // Commit what the form queued before the database closes
+    writeQueue->flush();
+    writerThread->quit();
+    writerThread->wait();
+
+    // Stop exports that are still running
+    for (auto it = activeExports.cbegin(); it != activeExports.cend(); ++it) {
+        it.value()->cancel();
+        it.key()->quit();
+        it.key()->wait();
+    }
+}
+
+void MainWindow::setupWorkers()
+{
+    loaderThread = new QThread(this);
+    transactionLoader = new TransactionLoader(&dbManager.connections());
+    transactionLoader->moveToThread(loaderThread);
+
+    connect(loaderThread, &QThread::finished, transactionLoader, &QObject::deleteLater);
+    connect(transactionLoader, &TransactionLoader::transactionsLoaded, this, &MainWindow::appendLoadedTransactions);
+    connect(transactionLoader, &TransactionLoader::loadingFinished, this, &MainWindow::finishLoading);
+
+    searchThread = new QThread(this);
+    searchWorker = new SearchWorker(&dbManager.connections(), dbManager.hasFullTextSearch());
+    searchWorker->moveToThread(searchThread);
+
+    connect(searchThread, &QThread::finished, searchWorker, &QObject::deleteLater);
+    connect(searchWorker, &SearchWorker::resultsReady, this, &MainWindow::appendSearchResults);
+
+    writerThread = new QThread(this);
+    writeQueue = new WriteBehindQueue(&dbManager.connections(), DatabaseManager::databasePath() + ".pending");
+    writeQueue->moveToThread(writerThread);
+
+    connect(writerThread, &QThread::finished, writeQueue, &QObject::deleteLater);
+    connect(writeQueue, &WriteBehindQueue::writesFailed, this, &MainWindow::rollBackFailedWrites);
+
+    // Charts follow a streaming load at most twice a second
+    analyticsRefreshTimer = new QTimer(this);
+    analyticsRefreshTimer->setSingleShot(true);
+    analyticsRefreshTimer->setInterval(500);
+    connect(analyticsRefreshTimer, &QTimer::timeout, this, &MainWindow::updateAnalytics);
+
+    loaderThread->start();
+    searchThread->start();
+    writerThread->start();
+
+    // Changes journaled but not committed when the last run ended go in
+    // before anything is loaded
+    int replayed = writeQueue->recover();
+    if (replayed > 0) {
+        qDebug() << "Replayed" << replayed << "uncommitted changes from the write journal";
+    }
 }
 
 void MainWindow::loadTransactionsFromDatabase()
 {
-    // Clear existing data
+    // Queued form changes are committed first so the reload includes them
+    writeQueue->flush();
+
+    // Dashboard totals come straight from the SQL aggregates, so they are
+    // right before the first row has arrived
+    totalIncome = dbManager.getTotalIncome();
+    totalExpenses = dbManager.getTotalExpenses();
+    currentBalance = dbManager.getTotalBalance();
+    updateBalance();
+
+    // Clear existing data; rows stream in from the loader thread
+    quint64 generation = ++loadGeneration;
+    transactionLoader->cancelBefore(generation);
+
+    transactionModel->beginResetTransactions();
     transactions.clear();
-    totalIncome = 0.0;
-    totalExpenses = 0.0;
-    currentBalance = 0.0;
+    transactionRows.clear();
+    transactionModel->endResetTransactions();
+    // Category and monthly charts are drawn from the summary table right away
+    analytics.clear();
+    analytics.loadSummary(dbManager.getSummary());
+    updateAnalytics();
 
-    // Load transactions
-    transactions = dbManager.getAllTransactions();
+    TransactionLoader *loader = transactionLoader;
+    QMetaObject::invokeMethod(transactionLoader, [loader, generation]() {
+        loader->load(generation);
+    }, Qt::QueuedConnection);
+}
 
-    // Recalculate totals
-    for (const Transaction& trans : transactions) {
-        if (trans.type() == Transaction::Income) {
-            totalIncome += trans.amount();
-            currentBalance += trans.amount();
-        } else {
-            totalExpenses += std::abs(trans.amount());
-            currentBalance -= std::abs(trans.amount());
+void MainWindow::appendLoadedTransactions(quint64 generation, const QVector<Transaction>& chunk)
+{
+    if (generation != loadGeneration)
+        return;
+
+    // Skip rows that were added from the form while the load was running
+    QVector<Transaction> fresh;
+    fresh.reserve(chunk.size());
+    for (const Transaction& trans : chunk) {
+        if (!transactionRows.contains(trans.id())) {
+            fresh.append(trans);
         }
     }
+    if (fresh.isEmpty())
+        return;
 
-    // Update UI
-    updateBalance();
-    updateTransactionTable();
+    int firstRow = transactions.size();
+    if (filterActive) {
+        appendStoredTransactions(fresh);
+    } else {
+        transactionModel->beginAppendTransactions(fresh.size());
+        appendStoredTransactions(fresh);
+        transactionModel->endAppendTransactions();
+    }
+
+    analytics.addTransactions(transactions, firstRow, fresh.size());
+    if (!analyticsRefreshTimer->isActive()) {
+        analyticsRefreshTimer->start();
+    }
+}
+
+void MainWindow::appendStoredTransactions(const QVector<Transaction>& newTransactions)
+{
+    int row = transactions.size();
+    transactions.append(newTransactions);
+    for (; row < transactions.size(); ++row) {
+        transactionRows.insert(transactions.id(row), row);
+    }
+}
+
+void MainWindow::removeStoredTransactions(const QSet<qint64>& ids)
+{
+    // Compact the store in one pass and reindex only the rows that moved
+    int firstRemoved = transactions.size();
+    for (qint64 id : ids) {
+        auto it = transactionRows.constFind(id);
+        if (it != transactionRows.constEnd()) {
+            firstRemoved = qMin(firstRemoved, it.value());
+        }
+    }
+
+    int kept = firstRemoved;
+    for (int row = firstRemoved; row < transactions.size(); ++row) {
+        qint64 id = transactions.id(row);
+        if (ids.contains(id)) {
+            transactionRows.remove(id);
+            continue;
+        }
+        if (kept != row) {
+            transactions.move(row, kept);
+        }
+        transactionRows[id] = kept;
+        ++kept;
+    }
+    transactions.truncate(kept);
+}
+
+void MainWindow::finishLoading(quint64 generation)
+{
+    if (generation != loadGeneration)
+        return;
+
+    analyticsRefreshTimer->stop();
     updateAnalytics();
 }
 void MainWindow::setupUI()
@@ -147,9 +304,128 @@ void MainWindow::setupUI()
 }
 void MainWindow::updateAnalytics()
 {
-    // Simply recreate the analytics page
-    delete analyticsPage->layout();
-    setupAnalyticsPage();
+    // Overview
+    analyticsIncomeLabel->setText(QString("Total Income: $%1").arg(totalIncome.toString()));
+    analyticsExpensesLabel->setText(QString("Total Expenses: $%1").arg(totalExpenses.toString()));
+    analyticsBalanceLabel->setText(QString("Net Balance: $%1").arg(currentBalance.toString()));
+
+    // Expense pie: update existing slices, add new categories, drop empty ones
+    static const QStringList colors = {
+        "#2ecc71", "#e74c3c", "#3498db", "#f1c40f",
+        "#9b59b6", "#1abc9c", "#e67e22", "#34495e"
+    };
+    const QMap<int, AnalyticsStore::CategoryTotal>& categoryTotals = analytics.categoryTotals();
+    for (auto it = categorySlices.begin(); it != categorySlices.end();) {
+        if (!categoryTotals.contains(it.key())) {
+            expensePieSeries->remove(it.value());
+            it = categorySlices.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = categoryTotals.cbegin(); it != categoryTotals.cend(); ++it) {
+        double percentage = !totalExpenses.isZero()
+                                ? double(it->amount.cents()) / totalExpenses.cents() * 100 : 0;
+        QString label = QString("%1\n$%2 (%3%)").arg(dbManager.categories().name(it.key()))
+                            .arg(it->amount.toString())
+                            .arg(percentage, 0, 'f', 1);
+
+        QPieSlice *slice = categorySlices.value(it.key());
+        if (!slice) {
+            slice = expensePieSeries->append(label, it->amount.toDouble());
+            slice->setBrush(QColor(colors[(expensePieSeries->count() - 1) % colors.size()]));
+            categorySlices.insert(it.key(), slice);
+        } else {
+            slice->setValue(it->amount.toDouble());
+            slice->setLabel(label);
+        }
+    }
+
+    // Period bars: rewrite only the values that changed
+    DateBucket::Granularity granularity = DateBucket::Granularity(periodCombo->currentData().toInt());
+    const QVector<AnalyticsStore::Period> periods = analytics.periodTotals(granularity);
+    QStringList labels;
+    labels.reserve(periods.size());
+    for (const AnalyticsStore::Period& period : periods) {
+        labels << DateBucket::label(granularity, period.key);
+    }
+    if (periodAxis->categories() != labels) {
+        periodAxis->setCategories(labels);
+    }
+    int index = 0;
+    double maxPeriod = 0.0;
+    for (const AnalyticsStore::Period& period : periods) {
+        double income = period.total.income.toDouble();
+        double expenses = period.total.expenses.toDouble();
+        if (index < periodIncomeSet->count()) {
+            if (periodIncomeSet->at(index) != income)
+                periodIncomeSet->replace(index, income);
+            if (periodExpenseSet->at(index) != expenses)
+                periodExpenseSet->replace(index, expenses);
+        } else {
+            periodIncomeSet->append(income);
+            periodExpenseSet->append(expenses);
+        }
+        maxPeriod = qMax(maxPeriod, qMax(income, expenses));
+        ++index;
+    }
+    if (periodIncomeSet->count() > index) {
+        periodIncomeSet->remove(index, periodIncomeSet->count() - index);
+        periodExpenseSet->remove(index, periodExpenseSet->count() - index);
+    }
+    periodValueAxis->setRange(0, maxPeriod > 0 ? maxPeriod : 1);
+    periodValueAxis->applyNiceNumbers();
+
+    // Balance trend: points before the earliest changed step keep their
+    // running balance, so only the points from there on are rewritten
+    qint64 changedFrom = 0;
+    QList<QPointF> changed;
+    if (!analytics.takeBalanceChanges(&changedFrom, &changed)) {
+        return;
+    }
+    int first = 0;
+    {
+        // The copy shares the series' points; it is dropped before they change
+        const QList<QPointF> current = balanceSeries->points();
+        first = int(std::lower_bound(current.cbegin(), current.cend(), double(changedFrom),
+                                     [](const QPointF& point, double x) { return point.x() < x; })
+                    - current.cbegin());
+    }
+    if (first == 0) {
+        balanceSeries->replace(changed);
+    } else {
+        for (int i = 0; i < changed.size(); ++i) {
+            int index = first + i;
+            if (index >= balanceSeries->count()) {
+                balanceSeries->append(changed.at(i));
+            } else if (balanceSeries->at(index) != changed.at(i)) {
+                balanceSeries->replace(index, changed.at(i));
+            }
+        }
+        int end = first + int(changed.size());
+        if (balanceSeries->count() > end) {
+            balanceSeries->removePoints(end, balanceSeries->count() - end);
+        }
+    }
+
+    balanceLows.resize(first);
+    balanceHighs.resize(first);
+    for (const QPointF& point : changed) {
+        balanceLows.append(balanceLows.isEmpty() ? point.y() : qMin(balanceLows.constLast(), point.y()));
+        balanceHighs.append(balanceHighs.isEmpty() ? point.y() : qMax(balanceHighs.constLast(), point.y()));
+    }
+    if (balanceSeries->count() > 0) {
+        balanceTimeAxis->setRange(QDateTime::fromMSecsSinceEpoch(qint64(balanceSeries->at(0).x())),
+                                  QDateTime::fromMSecsSinceEpoch(qint64(balanceSeries->at(balanceSeries->count() - 1).x())));
+        double minBalance = balanceLows.constLast();
+        double maxBalance = balanceHighs.constLast();
+        if (minBalance == maxBalance) {
+            minBalance -= 1;
+            maxBalance += 1;
+        }
+        balanceValueAxis->setRange(minBalance, maxBalance);
+        balanceValueAxis->applyNiceNumbers();
+    }
 }
 
 void MainWindow::showShortcutsDialog()
@@ -181,7 +457,7 @@ void MainWindow::showShortcutsDialog()
     };
 
     addShortcut("Ctrl + N", "Add new transaction");
-    addShortcut("Delete", "Delete selected transaction");
+    addShortcut("Delete", "Delete selected transactions");
     addShortcut("Ctrl + F", "Focus search box");
     addShortcut("F5", "Refresh transaction list");
 
@@ -216,17 +492,26 @@ void MainWindow::setupTransactionsPage()
     // Create transaction table
     setupTransactionTable();
 
+    // Create search and filter controls above the table
+    setupFilters();
+
+    // Fill both category selectors from the categories table
+    refreshCategoryLists();
+
     // Add export buttons
     QHBoxLayout *exportLayout = new QHBoxLayout;
+    QPushButton *importBtn = new QPushButton("Import CSV/OFX");
     QPushButton *exportCsvBtn = new QPushButton("Export to CSV");
     QPushButton *exportPdfBtn = new QPushButton("Export to PDF");
     QPushButton *exportExcelBtn = new QPushButton("Export to Excel");
 
+    exportLayout->addWidget(importBtn);
     exportLayout->addStretch();
     exportLayout->addWidget(exportCsvBtn);
     exportLayout->addWidget(exportPdfBtn);
     exportLayout->addWidget(exportExcelBtn);
 
+    connect(importBtn, &QPushButton::clicked, this, &MainWindow::importTransactions);
     connect(exportCsvBtn, &QPushButton::clicked, this, &MainWindow::exportToCSV);
     connect(exportPdfBtn, &QPushButton::clicked, this, &MainWindow::exportToPDF);
     connect(exportExcelBtn, &QPushButton::clicked, this, &MainWindow::exportToExcel);
@@ -237,36 +522,107 @@ void MainWindow::setupTransactionsPage()
 // Add the rest of your existing methods here (setupTransactionForm, setupTransactionTable, etc.)
 // but remove all chart-related code for now.
 
-void MainWindow::exportToCSV()
+void MainWindow::importTransactions()
 {
-    QString fileName = QFileDialog::getSaveFileName(this,
-                                                    "Export Transactions", "", "CSV Files (*.csv)");
+    QString fileName = QFileDialog::getOpenFileName(this,
+                                                    "Import Transactions", "",
+                                                    "Bank Statements (*.csv *.ofx *.qfx);;CSV Files (*.csv);;OFX Files (*.ofx *.qfx)");
 
     if (fileName.isEmpty())
         return;
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::critical(this, "Error", "Could not open file for writing.");
+    TransactionImporter importer(dbManager);
+    bool read = importer.readFile(fileName);
+    // The file may have introduced new categories
+    refreshCategoryLists();
+    if (!read) {
+        QMessageBox::critical(this, "Error", "Could not read the file:\n" + importer.errorString());
+        return;
+    }
+
+    const QVector<Transaction>& imported = importer.transactions();
+    if (imported.isEmpty()) {
+        QMessageBox::information(this, "Import", "No transactions found in the file.");
         return;
     }
 
-    QTextStream out(&file);
+    QProgressDialog progress("Importing transactions...", "Cancel", 0, imported.size(), this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(0);
 
-    // Write header
-    out << "Date,Type,Amount,Description,Category\n";
+    // Queued rows are committed first; the import takes the ids after them
+    writeQueue->flush();
+    int written = dbManager.addTransactions(imported, [&progress](int rows) {
+        progress.setValue(rows);
+        return !progress.wasCanceled();
+    });
+    progress.setValue(imported.size());
 
-    // Write transactions
-    for (const Transaction& trans : transactions) {
-        out << trans.datetime().toString("yyyy-MM-dd hh:mm") << ","
-            << (trans.type() == Transaction::Income ? "Income" : "Expense") << ","
-            << QString::number(std::abs(trans.amount()), 'f', 2) << ","
-            << "\"" << trans.description().replace("\"", "\"\"") << "\"" << ","
-            << trans.category() << "\n";
+    // Reload through the background loader so totals and charts pick up
+    // the new rows
+    loadTransactionsFromDatabase();
+    if (filterActive) {
+        updateTransactionTable();
+    }
+
+    QString message = QString("Imported %1 of %2 transactions.").arg(written).arg(imported.size());
+    if (importer.skippedRecords() > 0) {
+        message += QString("\n%1 unreadable records were skipped.").arg(importer.skippedRecords());
     }
+    QMessageBox::information(this, "Import", message);
+}
+
+void MainWindow::exportToCSV()
+{
+    QString fileName = QFileDialog::getSaveFileName(this,
+                                                    "Export Transactions", "", "CSV Files (*.csv)");
+
+    if (fileName.isEmpty())
+        return;
 
-    file.close();
-    QMessageBox::information(this, "Success", "Transactions exported successfully!");
+    // Exports what the table shows: the active filter, or everything
+    startExport(new CsvExporter(&dbManager.connections(), fileName,
+                                currentFilter(), dbManager.hasFullTextSearch()),
+                "Exporting transactions...", transactionModel->rowCount());
+}
+
+void MainWindow::startExport(ExportWorker *exporter, const QString& label, int expectedRows)
+{
+    writeQueue->flush();
+
+    QThread *thread = new QThread(this);
+    exporter->moveToThread(thread);
+    activeExports.insert(thread, exporter);
+
+    QProgressDialog *progress = new QProgressDialog(label, "Cancel", 0, qMax(expectedRows, 1), this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(500);
+    progress->setAutoClose(false);
+    progress->setAutoReset(false);
+
+    connect(thread, &QThread::started, exporter, &ExportWorker::run);
+    connect(exporter, &ExportWorker::progressChanged, progress, [progress](int rows) {
+        progress->setValue(qMin(rows, progress->maximum()));
+    });
+    // cancel() only flips an atomic flag, so it is called directly
+    connect(progress, &QProgressDialog::canceled, exporter, [exporter]() {
+        exporter->cancel();
+    }, Qt::DirectConnection);
+    connect(exporter, &ExportWorker::finished, this, [this, thread, progress](bool success, const QString& message) {
+        progress->deleteLater();
+        activeExports.remove(thread);
+        thread->quit();
+
+        if (success) {
+            QMessageBox::information(this, "Success", message);
+        } else {
+            QMessageBox::warning(this, "Export", message);
+        }
+    });
+    connect(thread, &QThread::finished, exporter, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+
+    thread->start();
 }
 
 void MainWindow::exportToPDF()
@@ -277,46 +633,34 @@ void MainWindow::exportToPDF()
     if (fileName.isEmpty())
         return;
 
-    QPrinter printer(QPrinter::HighResolution);
-    printer.setOutputFormat(QPrinter::PdfFormat);
-    printer.setOutputFileName(fileName);
-    printer.setPageOrientation(QPageLayout::Landscape);
-
-    QTextDocument doc;
-    QString html = "<h1>Finance Tracker - Transaction Report</h1>";
-    html += "<p>Generated on: " + QDateTime::currentDateTime().toString() + "</p>";
-
-    // Add summary
-    html += "<h2>Summary</h2>";
-    html += "<p>Total Income: $" + QString::number(totalIncome, 'f', 2) + "<br>";
-    html += "Total Expenses: $" + QString::number(totalExpenses, 'f', 2) + "<br>";
-    html += "Current Balance: $" + QString::number(currentBalance, 'f', 2) + "</p>";
-
-    // Add transactions table
-    html += "<h2>Transactions</h2>";
-    html += "<table border='1' cellspacing='0' cellpadding='3' width='100%'>";
-    html += "<tr bgcolor='#f0f0f0'><th>Date</th><th>Type</th><th>Amount</th><th>Description</th><th>Category</th></tr>";
-
-    for (const Transaction& trans : transactions) {
-        html += "<tr>";
-        html += "<td>" + trans.datetime().toString("yyyy-MM-dd hh:mm") + "</td>";
-        html += "<td>" + QString(trans.type() == Transaction::Income ? "Income" : "Expense") + "</td>";
-        html += "<td align='right'>$" + QString::number(std::abs(trans.amount()), 'f', 2) + "</td>";
-        html += "<td>" + trans.description() + "</td>";
-        html += "<td>" + trans.category() + "</td>";
-        html += "</tr>";
-    }
-    html += "</table>";
+    PdfReportRenderer::Summary summary;
+    summary.totalIncome = totalIncome;
+    summary.totalExpenses = totalExpenses;
+    summary.currentBalance = currentBalance;
 
-    doc.setHtml(html);
-    doc.print(&printer);
-
-    QMessageBox::information(this, "Success", "Report exported to PDF successfully!");
+    startExport(new PdfReportRenderer(&dbManager.connections(), fileName,
+                                      currentFilter(), dbManager.hasFullTextSearch(), summary),
+                "Rendering PDF report...", transactionModel->rowCount());
 }
 void MainWindow::exportToExcel()
 {
-    // We'll use CSV since Excel can open it
-    exportToCSV();
+    QString fileName = QFileDialog::getSaveFileName(this,
+                                                    "Export Transactions", "", "Excel Workbooks (*.xlsx)");
+
+    if (fileName.isEmpty())
+        return;
+
+    QStringList groupings = {"One sheet per month", "One sheet per category"};
+    bool ok = false;
+    QString grouping = QInputDialog::getItem(this, "Export to Excel", "Split the workbook into:",
+                                             groupings, 0, false, &ok);
+    if (!ok)
+        return;
+
+    startExport(new XlsxExporter(&dbManager.connections(), fileName,
+                                 currentFilter(), dbManager.hasFullTextSearch(),
+                                 grouping == groupings[1] ? XlsxExporter::ByCategory : XlsxExporter::ByMonth),
+                "Exporting workbook...", transactionModel->rowCount());
 }
 // Navigation methods
 void MainWindow::setupNavigation()
@@ -418,7 +762,6 @@ void MainWindow::setupTransactionForm()
     // Category selector
     grid->addWidget(new QLabel("Category:"), 2, 0);
     categoryCombo = new QComboBox;
-    categoryCombo->addItems({"Salary", "Food", "Transport", "Entertainment", "Bills", "Shopping", "Other"});
     grid->addWidget(categoryCombo, 2, 1);
 
     // Date and time picker
@@ -447,20 +790,26 @@ void MainWindow::setupTransactionForm()
 
 void MainWindow::setupTransactionTable()
 {
-    transactionTable = new QTableWidget;
-    transactionTable->setColumnCount(5);
-    transactionTable->setHorizontalHeaderLabels({"Type", "Amount", "Description", "Category", "Date/Time"});
+    transactionModel = new TransactionTableModel(&transactions, this);
+
+    transactionTable = new QTableView;
+    transactionTable->setModel(transactionModel);
 
     // Style the table
     transactionTable->setAlternatingRowColors(true);
     transactionTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     transactionTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     transactionTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    transactionTable->setSelectionMode(QAbstractItemView::ExtendedSelection);
     transactionTable->verticalHeader()->setVisible(false);
 
+    // Fixed row heights keep scrolling independent of the row count
+    transactionTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    transactionTable->verticalHeader()->setDefaultSectionSize(transactionTable->fontMetrics().height() + 10);
+
     // Enable context menu
     transactionTable->setContextMenuPolicy(Qt::CustomContextMenu);
-    connect(transactionTable, &QTableWidget::customContextMenuRequested,
+    connect(transactionTable, &QTableView::customContextMenuRequested,
             this, &MainWindow::handleTransactionTableContextMenu);
 
     // Add table to transactions page
@@ -529,7 +878,7 @@ void MainWindow::setTheme(bool darkTheme)
                 border-radius: 10px;
                 padding: 15px;
             }
-            QTableWidget {
+            QTableView {
                 background-color: #252525;
                 alternate-background-color: #2d2d2d;
                 border: none;
@@ -598,7 +947,7 @@ void MainWindow::setTheme(bool darkTheme)
                 border-radius: 10px;
                 padding: 15px;
             }
-            QTableWidget {
+            QTableView {
                 background-color: #ffffff;
                 alternate-background-color: #f5f5f5;
                 border: none;
@@ -645,9 +994,9 @@ void MainWindow::setTheme(bool darkTheme)
         expenseChartView->chart()->setTheme(darkTheme ? QChart::ChartThemeDark : QChart::ChartThemeLight);
         expenseChartView->chart()->setBackgroundVisible(false);
     }
-    if (monthlyComparisonChart && monthlyComparisonChart->chart()) {
-        monthlyComparisonChart->chart()->setTheme(darkTheme ? QChart::ChartThemeDark : QChart::ChartThemeLight);
-        monthlyComparisonChart->chart()->setBackgroundVisible(false);
+    if (periodComparisonChart && periodComparisonChart->chart()) {
+        periodComparisonChart->chart()->setTheme(darkTheme ? QChart::ChartThemeDark : QChart::ChartThemeLight);
+        periodComparisonChart->chart()->setBackgroundVisible(false);
     }
     if (balanceTrendChart && balanceTrendChart->chart()) {
         balanceTrendChart->chart()->setTheme(darkTheme ? QChart::ChartThemeDark : QChart::ChartThemeLight);
@@ -657,9 +1006,9 @@ void MainWindow::setTheme(bool darkTheme)
 void MainWindow::addNewTransaction()
 {
     bool ok;
-    double amount = amountEdit->text().toDouble(&ok);
+    Money amount = Money::fromString(amountEdit->text(), &ok);
 
-    if (!ok || amount <= 0) {
+    if (!ok || amount <= Money()) {
         QMessageBox::warning(this, "Invalid Input", "Please enter a valid amount.");
         return;
     }
@@ -672,62 +1021,47 @@ void MainWindow::addNewTransaction()
     }
 
     Transaction transaction(type, amount, descriptionEdit->text(),
-                            categoryCombo->currentText(), dateTimeEdit->dateTime());
-
-    if (!dbManager.addTransaction(transaction)) {
-        QMessageBox::critical(this, "Error", "Failed to save transaction to database!");
-        return;
-    }
+                            categoryCombo->currentData().toInt(), dateTimeEdit->dateTime());
 
-    // Store transaction in vector
-    transactions.append(transaction);
+    // The row shows up at once; the queue journals it and commits it with
+    // its neighbours, and rollBackFailedWrites() takes it out if that fails
+    transaction.setId(writeQueue->reserveId());
+    writeQueue->insert(transaction);
 
-    // Add to table
-    int row = transactionTable->rowCount();
-    transactionTable->insertRow(row);
-
-    QTableWidgetItem *typeItem = new QTableWidgetItem(type == Transaction::Income ? "Income" : "Expense");
-    typeItem->setForeground(type == Transaction::Income ? Qt::darkGreen : Qt::red);
-
-    transactionTable->setItem(row, 0, typeItem);
-    transactionTable->setItem(row, 1, new QTableWidgetItem(QString::number(std::abs(amount), 'f', 2)));
-    transactionTable->setItem(row, 2, new QTableWidgetItem(descriptionEdit->text()));
-    transactionTable->setItem(row, 3, new QTableWidgetItem(categoryCombo->currentText()));
-    transactionTable->setItem(row, 4, new QTableWidgetItem(dateTimeEdit->dateTime().toString("yyyy-MM-dd hh:mm")));
+    // Store the transaction; the model only announces the new row
+    if (filterActive) {
+        appendStoredTransactions({transaction});
+        updateTransactionTable();
+    } else {
+        transactionModel->beginAppendTransactions(1);
+        appendStoredTransactions({transaction});
+        transactionModel->endAppendTransactions();
+    }
 
-    // Update totals
+    // Update totals; integer cents, so repeated updates never drift
     if (type == Transaction::Income) {
-        totalIncome += std::abs(amount);
+        totalIncome += amount.abs();
         currentBalance += amount;
     } else {
-        totalExpenses += std::abs(amount);
+        totalExpenses += amount.abs();
         currentBalance += amount;  // amount is already negative
     }
 
+    analytics.addTransaction(transaction);
+
     // Update UI
     updateBalance();
-    delete analyticsPage->layout();
-    setupAnalyticsPage();  // Refresh analytics
+    updateAnalytics();
 
     // Clear form
     clearTransactionForm();
 
-    QMessageBox::information(this, "Success", "Transaction added successfully!");
+    statusBar()->showMessage("Transaction added", 3000);
 }
 
 void MainWindow::setupAnalyticsPage()
 {
-    // First, clear everything from the analytics page
-    if (analyticsPage->layout()) {
-        QLayoutItem* item;
-        while ((item = analyticsPage->layout()->takeAt(0)) != nullptr) {
-            delete item->widget();
-            delete item;
-        }
-        delete analyticsPage->layout();
-    }
-
-    // Create a single main layout
+    // The page is built once; updateAnalytics() feeds the series afterwards
     QVBoxLayout *mainLayout = new QVBoxLayout(analyticsPage);
     mainLayout->setContentsMargins(0, 0, 0, 0);
     mainLayout->setSpacing(0);
@@ -748,53 +1082,28 @@ void MainWindow::setupAnalyticsPage()
     QGroupBox *overviewGroup = new QGroupBox("Financial Overview");
     QVBoxLayout *overviewLayout = new QVBoxLayout(overviewGroup);
 
-    QLabel *totalIncomeLabel = new QLabel(QString("Total Income: $%1").arg(totalIncome, 0, 'f', 2));
-    QLabel *totalExpensesLabel = new QLabel(QString("Total Expenses: $%1").arg(totalExpenses, 0, 'f', 2));
-    QLabel *netBalanceLabel = new QLabel(QString("Net Balance: $%1").arg(currentBalance, 0, 'f', 2));
+    analyticsIncomeLabel = new QLabel("Total Income: $0.00");
+    analyticsExpensesLabel = new QLabel("Total Expenses: $0.00");
+    analyticsBalanceLabel = new QLabel("Net Balance: $0.00");
 
-    totalIncomeLabel->setStyleSheet("color: #2ecc71; font-size: 16px; padding: 10px;");
-    totalExpensesLabel->setStyleSheet("color: #e74c3c; font-size: 16px; padding: 10px;");
-    netBalanceLabel->setStyleSheet("font-size: 18px; font-weight: bold; padding: 10px;");
+    analyticsIncomeLabel->setStyleSheet("color: #2ecc71; font-size: 16px; padding: 10px;");
+    analyticsExpensesLabel->setStyleSheet("color: #e74c3c; font-size: 16px; padding: 10px;");
+    analyticsBalanceLabel->setStyleSheet("font-size: 18px; font-weight: bold; padding: 10px;");
 
-    overviewLayout->addWidget(totalIncomeLabel);
-    overviewLayout->addWidget(totalExpensesLabel);
-    overviewLayout->addWidget(netBalanceLabel);
+    overviewLayout->addWidget(analyticsIncomeLabel);
+    overviewLayout->addWidget(analyticsExpensesLabel);
+    overviewLayout->addWidget(analyticsBalanceLabel);
 
     // Expense Pie Chart Section
     QGroupBox *pieChartGroup = new QGroupBox("Expenses by Category");
     QVBoxLayout *pieChartLayout = new QVBoxLayout(pieChartGroup);
 
-    // Create pie chart
-    QPieSeries *pieSeries = new QPieSeries();
-
-    // Calculate category totals for pie chart
-    QMap<QString, double> categoryTotals;
-    for (const Transaction& trans : transactions) {
-        if (trans.type() == Transaction::Expense) {
-            categoryTotals[trans.category()] += std::abs(trans.amount());
-        }
-    }
-
-    // Add slices to pie chart with consistent colors
-    QStringList colors = {
-        "#2ecc71", "#e74c3c", "#3498db", "#f1c40f",
-        "#9b59b6", "#1abc9c", "#e67e22", "#34495e"
-    };
-    int colorIndex = 0;
-
-    for (auto it = categoryTotals.begin(); it != categoryTotals.end(); ++it) {
-        double percentage = (totalExpenses > 0) ? (it.value() / totalExpenses * 100) : 0;
-        QPieSlice *slice = pieSeries->append(it.key(), it.value());
-        slice->setLabel(QString("%1\n$%2 (%3%)").arg(it.key())
-                            .arg(it.value(), 0, 'f', 2)
-                            .arg(percentage, 0, 'f', 1));
-        slice->setBrush(QColor(colors[colorIndex % colors.size()]));
-        colorIndex++;
-    }
+    // Create pie chart; slices are added by updateAnalytics()
+    expensePieSeries = new QPieSeries();
 
     // Create and customize pie chart
     QChart *pieChart = new QChart();
-    pieChart->addSeries(pieSeries);
+    pieChart->addSeries(expensePieSeries);
     pieChart->setTitle("Expense Distribution");
     pieChart->legend()->setAlignment(Qt::AlignRight);
     pieChart->setBackgroundVisible(false);
@@ -806,95 +1115,76 @@ void MainWindow::setupAnalyticsPage()
     expenseChartView->setMinimumHeight(300);
     pieChartLayout->addWidget(expenseChartView);
 
-    // Monthly Income vs Expenses Bar Chart Section
-    QGroupBox *barChartGroup = new QGroupBox("Monthly Income vs Expenses");
+    // Income vs Expenses Bar Chart Section, bucketed by the chosen period
+    QGroupBox *barChartGroup = new QGroupBox("Income vs Expenses");
     QVBoxLayout *barChartLayout = new QVBoxLayout(barChartGroup);
 
-    // Calculate monthly data
-    QMap<QString, QPair<double, double>> monthlyData;
-    QStringList months;
-    for (const Transaction& trans : transactions) {
-        QString month = trans.datetime().toString("yyyy-MM");
-        if (trans.type() == Transaction::Income) {
-            monthlyData[month].first += trans.amount();
-        } else {
-            monthlyData[month].second += std::abs(trans.amount());
-        }
+    QHBoxLayout *periodLayout = new QHBoxLayout();
+    periodCombo = new QComboBox();
+    for (DateBucket::Granularity granularity : {DateBucket::Day, DateBucket::Week, DateBucket::Month,
+                                                DateBucket::Quarter, DateBucket::Year}) {
+        periodCombo->addItem(DateBucket::name(granularity), granularity);
     }
+    periodCombo->setCurrentIndex(periodCombo->findData(DateBucket::Month));
+    connect(periodCombo, &QComboBox::currentIndexChanged, this, &MainWindow::updateAnalytics);
+    periodLayout->addWidget(new QLabel("Group by:"));
+    periodLayout->addWidget(periodCombo);
+    periodLayout->addStretch();
+    barChartLayout->addLayout(periodLayout);
 
     // Create bar chart
     QBarSeries *barSeries = new QBarSeries();
-    QBarSet *incomeSet = new QBarSet("Income");
-    QBarSet *expenseSet = new QBarSet("Expenses");
-
-    for (auto it = monthlyData.begin(); it != monthlyData.end(); ++it) {
-        months << it.key();
-        *incomeSet << it.value().first;
-        *expenseSet << it.value().second;
-    }
+    periodIncomeSet = new QBarSet("Income");
+    periodExpenseSet = new QBarSet("Expenses");
 
-    incomeSet->setColor(QColor("#2ecc71")); // Green for income
-    expenseSet->setColor(QColor("#e74c3c")); // Red for expenses
-    barSeries->append(incomeSet);
-    barSeries->append(expenseSet);
+    periodIncomeSet->setColor(QColor("#2ecc71")); // Green for income
+    periodExpenseSet->setColor(QColor("#e74c3c")); // Red for expenses
+    barSeries->append(periodIncomeSet);
+    barSeries->append(periodExpenseSet);
 
     QChart *barChart = new QChart();
     barChart->addSeries(barSeries);
-    barChart->setTitle("Monthly Comparison");
+    barChart->setTitle("Comparison by Period");
     barChart->setTheme(isDarkTheme ? QChart::ChartThemeDark : QChart::ChartThemeLight);
     barChart->setBackgroundVisible(false);
 
-    QBarCategoryAxis *axisX = new QBarCategoryAxis();
-    axisX->append(months);
-    barChart->addAxis(axisX, Qt::AlignBottom);
-    barSeries->attachAxis(axisX);
+    periodAxis = new QBarCategoryAxis();
+    barChart->addAxis(periodAxis, Qt::AlignBottom);
+    barSeries->attachAxis(periodAxis);
 
-    QValueAxis *axisY = new QValueAxis();
-    barChart->addAxis(axisY, Qt::AlignLeft);
-    barSeries->attachAxis(axisY);
+    periodValueAxis = new QValueAxis();
+    barChart->addAxis(periodValueAxis, Qt::AlignLeft);
+    barSeries->attachAxis(periodValueAxis);
 
-    monthlyComparisonChart = new QChartView(barChart);
-    monthlyComparisonChart->setRenderHint(QPainter::Antialiasing);
-    monthlyComparisonChart->setMinimumHeight(300);
-    barChartLayout->addWidget(monthlyComparisonChart);
+    periodComparisonChart = new QChartView(barChart);
+    periodComparisonChart->setRenderHint(QPainter::Antialiasing);
+    periodComparisonChart->setMinimumHeight(300);
+    barChartLayout->addWidget(periodComparisonChart);
 
     // Balance Trend Line Chart Section
     QGroupBox *lineChartGroup = new QGroupBox("Balance Trend");
     QVBoxLayout *lineChartLayout = new QVBoxLayout(lineChartGroup);
 
-    QLineSeries *balanceSeries = new QLineSeries();
+    balanceSeries = new QLineSeries();
     balanceSeries->setName("Balance");
     QPen pen = balanceSeries->pen();
     pen.setWidth(2);
     balanceSeries->setPen(pen);
 
-    // Calculate running balance for line chart
-    QVector<Transaction> sortedTransactions = transactions;
-    std::sort(sortedTransactions.begin(), sortedTransactions.end(),
-              [](const Transaction& a, const Transaction& b) {
-                  return a.datetime() < b.datetime();
-              });
-
-    double runningBalance = 0;
-    for (const Transaction& trans : sortedTransactions) {
-        runningBalance += (trans.type() == Transaction::Income ? trans.amount() : -std::abs(trans.amount()));
-        balanceSeries->append(trans.datetime().toMSecsSinceEpoch(), runningBalance);
-    }
-
     QChart *lineChart = new QChart();
     lineChart->addSeries(balanceSeries);
     lineChart->setTitle("Balance Over Time");
     lineChart->setTheme(isDarkTheme ? QChart::ChartThemeDark : QChart::ChartThemeLight);
     lineChart->setBackgroundVisible(false);
 
-    QDateTimeAxis *axisX2 = new QDateTimeAxis;
-    axisX2->setFormat("MM-dd-yyyy");
-    lineChart->addAxis(axisX2, Qt::AlignBottom);
-    balanceSeries->attachAxis(axisX2);
+    balanceTimeAxis = new QDateTimeAxis;
+    balanceTimeAxis->setFormat("MM-dd-yyyy");
+    lineChart->addAxis(balanceTimeAxis, Qt::AlignBottom);
+    balanceSeries->attachAxis(balanceTimeAxis);
 
-    QValueAxis *axisY2 = new QValueAxis;
-    lineChart->addAxis(axisY2, Qt::AlignLeft);
-    balanceSeries->attachAxis(axisY2);
+    balanceValueAxis = new QValueAxis;
+    lineChart->addAxis(balanceValueAxis, Qt::AlignLeft);
+    balanceSeries->attachAxis(balanceValueAxis);
 
     balanceTrendChart = new QChartView(lineChart);
     balanceTrendChart->setRenderHint(QPainter::Antialiasing);
@@ -916,14 +1206,14 @@ void MainWindow::setupAnalyticsPage()
 }
 void MainWindow::updateBalance()
 {
-    balanceLabel->setText(QString("$%1").arg(currentBalance, 0, 'f', 2));
-    incomeLabel->setText(QString("Income: $%1").arg(totalIncome, 0, 'f', 2));
-    expenseLabel->setText(QString("Expenses: $%1").arg(totalExpenses, 0, 'f', 2));
+    balanceLabel->setText(QString("$%1").arg(currentBalance.toString()));
+    incomeLabel->setText(QString("Income: $%1").arg(totalIncome.toString()));
+    expenseLabel->setText(QString("Expenses: $%1").arg(totalExpenses.toString()));
 
     // Update balance label color based on amount
-    if (currentBalance > 0) {
+    if (currentBalance > Money()) {
         balanceLabel->setStyleSheet("color: #2ecc71;"); // Green for positive
-    } else if (currentBalance < 0) {
+    } else if (currentBalance.isNegative()) {
         balanceLabel->setStyleSheet("color: #e74c3c;"); // Red for negative
     } else {
         balanceLabel->setStyleSheet(""); // Default color for zero
@@ -941,38 +1231,62 @@ void MainWindow::clearTransactionForm()
 
 void MainWindow::updateTransactionTable()
 {
-    transactionTable->setRowCount(0);  // Clear table
-
-    // Update the table with current transactions
-    for (const Transaction& trans : transactions) {
-        int row = transactionTable->rowCount();
-        transactionTable->insertRow(row);
-
-        QTableWidgetItem *typeItem = new QTableWidgetItem(
-            trans.type() == Transaction::Income ? "Income" : "Expense");
-        typeItem->setForeground(
-            trans.type() == Transaction::Income ? Qt::darkGreen : Qt::red);
-
-        transactionTable->setItem(row, 0, typeItem);
-        transactionTable->setItem(row, 1, new QTableWidgetItem(QString::number(std::abs(trans.amount()), 'f', 2)));
-        transactionTable->setItem(row, 2, new QTableWidgetItem(trans.description()));
-        transactionTable->setItem(row, 3, new QTableWidgetItem(trans.category()));
-        transactionTable->setItem(row, 4, new QTableWidgetItem(trans.datetime().toString("yyyy-MM-dd hh:mm")));
+    TransactionFilter filter = currentFilter();
+
+    // Any search still running on the worker is now stale
+    quint64 generation = ++searchGeneration;
+    searchWorker->cancelBefore(generation);
+
+    // Cells are formatted lazily by the model, so a reset is all it takes
+    transactionModel->beginResetTransactions();
+    filteredTransactions.clear();
+    if (filter.isEmpty()) {
+        filterActive = false;
+        transactionModel->setTransactions(&transactions);
+    } else {
+        filterActive = true;
+        transactionModel->setTransactions(&filteredTransactions);
+    }
+    transactionModel->endResetTransactions();
+
+    // Filtered rows arrive in batches from the worker's own connection,
+    // which only sees committed rows
+    if (filterActive) {
+        writeQueue->flush();
+        SearchWorker *worker = searchWorker;
+        QMetaObject::invokeMethod(searchWorker, [worker, generation, filter]() {
+            worker->search(generation, filter);
+        }, Qt::QueuedConnection);
     }
 }
 
+void MainWindow::appendSearchResults(quint64 generation, const QVector<Transaction>& batch)
+{
+    // Drop batches from searches that were superseded in the meantime
+    if (generation != searchGeneration || !filterActive)
+        return;
+
+    transactionModel->beginAppendTransactions(batch.size());
+    filteredTransactions.append(batch);
+    transactionModel->endAppendTransactions();
+}
+
 void MainWindow::searchTransactions()
 {
-    updateTransactionTable();  // For now, just refresh the table
+    // Wait for a pause in typing before querying
+    searchDebounceTimer->start();
 }
 void MainWindow::applyFilters()
 {
-    updateTransactionTable();  // For now, just refresh the table
+    filtersApplied = true;
+    updateTransactionTable();
 }
 
 void MainWindow::clearFilters()
 {
+    filtersApplied = false;
     searchEdit->clear();
+    searchDebounceTimer->stop();
     categoryFilter->setCurrentIndex(0);
     minAmountFilter->clear();
     maxAmountFilter->clear();
@@ -981,62 +1295,229 @@ void MainWindow::clearFilters()
 
     updateTransactionTable();
 }
-void MainWindow::deleteSelectedTransaction()
+QVector<Transaction> MainWindow::selectedTransactions(QList<int> *rows) const
 {
-    int row = transactionTable->currentRow();
-    if (row < 0) return;  // No row selected
+    QList<int> selectedRows;
+    const QModelIndexList indexes = transactionTable->selectionModel()->selectedRows();
+    for (const QModelIndex& index : indexes) {
+        selectedRows << index.row();
+    }
+    std::sort(selectedRows.begin(), selectedRows.end());
 
-    Transaction trans = transactions[row];
+    QVector<Transaction> selected;
+    selected.reserve(selectedRows.size());
+    for (int row : selectedRows) {
+        selected.append(transactionModel->transactionAt(row));
+    }
+
+    if (rows) {
+        *rows = selectedRows;
+    }
+    return selected;
+}
+
+void MainWindow::deleteSelectedTransaction()
+{
+    QList<int> rows;
+    QVector<Transaction> selected = selectedTransactions(&rows);
+    if (selected.isEmpty()) return;  // No row selected
 
     // Show confirmation dialog
+    QString question;
+    if (selected.size() == 1) {
+        const Transaction& trans = selected.first();
+        question = "Are you sure you want to delete this transaction?\n\n"
+                   "Type: " + QString(trans.type() == Transaction::Income ? "Income" : "Expense") + "\n" +
+                   "Amount: $" + trans.amount().abs().toString() + "\n" +
+                   "Description: " + trans.description();
+    } else {
+        question = QString("Are you sure you want to delete these %1 transactions?").arg(selected.size());
+    }
+
     QMessageBox::StandardButton reply;
-    reply = QMessageBox::question(this, "Confirm Delete",
-                                  "Are you sure you want to delete this transaction?\n\n"
-                                  "Type: " + QString(trans.type() == Transaction::Income ? "Income" : "Expense") + "\n" +
-                                      "Amount: $" + QString::number(std::abs(trans.amount()), 'f', 2) + "\n" +
-                                      "Description: " + trans.description(),
-                                  QMessageBox::Yes | QMessageBox::No);
+    reply = QMessageBox::question(this, "Confirm Delete", question, QMessageBox::Yes | QMessageBox::No);
 
     if (reply == QMessageBox::Yes) {
-        // Delete from database first
-        if (!dbManager.deleteTransaction(
-                trans.datetime().toString(Qt::ISODate),
-                trans.amount(),
-                trans.description())) {
-            QMessageBox::critical(this, "Error", "Failed to delete transaction from database!");
-            return;
+        // The rows go from the model now and from the database with the
+        // queue's next commit
+        QVector<qint64> ids;
+        ids.reserve(selected.size());
+        for (const Transaction& trans : selected) {
+            ids.append(trans.id());
         }
+        writeQueue->remove(selected);
+
+        // Apply one combined delta to the totals
+        Money incomeDelta;
+        Money expenseDelta;
+        for (const Transaction& trans : selected) {
+            if (trans.type() == Transaction::Income) {
+                incomeDelta += trans.amount().abs();
+            } else {
+                expenseDelta += trans.amount().abs();
+            }
+            analytics.removeTransaction(trans);
+        }
+        totalIncome -= incomeDelta;
+        totalExpenses -= expenseDelta;
+        currentBalance -= incomeDelta - expenseDelta;
+
+        // Remove from the stores; a single row is announced as such, a
+        // batch as one reset
+        QSet<qint64> idSet(ids.cbegin(), ids.cend());
+        if (selected.size() == 1) {
+            transactionModel->beginRemoveTransaction(rows.first());
+        } else {
+            transactionModel->beginResetTransactions();
+        }
+        if (filterActive) {
+            // One compaction pass, like removeStoredTransactions()
+            int kept = *std::min_element(rows.cbegin(), rows.cend());
+            for (int row = kept; row < filteredTransactions.size(); ++row) {
+                if (idSet.contains(filteredTransactions.id(row))) {
+                    continue;
+                }
+                if (kept != row) {
+                    filteredTransactions.move(row, kept);
+                }
+                ++kept;
+            }
+            filteredTransactions.truncate(kept);
+        }
+        removeStoredTransactions(idSet);
+        if (selected.size() == 1) {
+            transactionModel->endRemoveTransaction();
+        } else {
+            transactionModel->endResetTransactions();
+        }
+
+        // Update UI once for the whole batch
+        updateBalance();
+        updateAnalytics();
+
+        statusBar()->showMessage(selected.size() == 1 ? QString("Transaction deleted")
+                                                      : QString("%1 transactions deleted").arg(selected.size()),
+                                 3000);
+    }
+}
 
-        // If database delete was successful, update totals and UI
+void MainWindow::rollBackFailedWrites(const QVector<Transaction>& inserted, const QVector<Transaction>& removed,
+                                      const QString& error)
+{
+    // Only changes the model still shows are undone; a row whose insert
+    // failed may have been deleted again in the meantime
+    auto adjustTotals = [this](const Transaction& trans, int direction) {
         if (trans.type() == Transaction::Income) {
-            totalIncome -= std::abs(trans.amount());
-            currentBalance -= trans.amount();
+            totalIncome += trans.amount().abs() * direction;
         } else {
-            totalExpenses -= std::abs(trans.amount());
-            currentBalance += std::abs(trans.amount());  // Add back the negative amount
+            totalExpenses += trans.amount().abs() * direction;
         }
+        currentBalance += trans.amount() * direction;
+    };
 
-        // Remove from transactions vector
-        transactions.remove(row);
+    QSet<qint64> dropped;
+    for (const Transaction& trans : inserted) {
+        if (transactionRows.contains(trans.id()) && !dropped.contains(trans.id())) {
+            dropped.insert(trans.id());
+            adjustTotals(trans, -1);
+            analytics.removeTransaction(trans);
+        }
+    }
+    QVector<Transaction> restored;
+    QSet<qint64> restoredIds;
+    for (const Transaction& trans : removed) {
+        if (!transactionRows.contains(trans.id()) && !restoredIds.contains(trans.id())) {
+            restoredIds.insert(trans.id());
+            restored.append(trans);
+            adjustTotals(trans, 1);
+            analytics.addTransaction(trans);
+        }
+    }
 
-        // Update UI
-        updateBalance();
+    transactionModel->beginResetTransactions();
+    removeStoredTransactions(dropped);
+    appendStoredTransactions(restored);
+    transactionModel->endResetTransactions();
+    if (filterActive) {
         updateTransactionTable();
-        updateAnalytics();
+    }
+
+    updateBalance();
+    updateAnalytics();
+
+    QMessageBox::warning(this, "Error",
+                         QString("%1 change(s) could not be saved and were undone.\n\n%2")
+                             .arg(inserted.size() + removed.size()).arg(error));
+}
+
+void MainWindow::editSelectedCategory()
+{
+    QList<int> rows;
+    QVector<Transaction> selected = selectedTransactions(&rows);
+    if (selected.isEmpty()) return;  // No row selected
+
+    bool ok = false;
+    QString category = QInputDialog::getItem(this, "Change Category",
+                                             QString("New category for %1 transaction(s):").arg(selected.size()),
+                                             dbManager.categories().categoryNames(), 0, false, &ok);
+    if (!ok)
+        return;
+    int categoryId = dbManager.categories().id(category);
 
-        QMessageBox::information(this, "Success", "Transaction deleted successfully!");
+    QVector<Transaction> updated;
+    updated.reserve(selected.size());
+    for (const Transaction& trans : selected) {
+        updated.append(Transaction(trans.type(), trans.amount(), trans.description(),
+                                   categoryId, trans.datetime(), trans.id()));
+    }
+
+    // All rows are written in one SQL transaction, after any queued inserts
+    writeQueue->flush();
+    if (!dbManager.updateTransactions(updated)) {
+        QMessageBox::critical(this, "Error", "Failed to update transactions in database!");
+        return;
     }
+
+    for (int i = 0; i < updated.size(); ++i) {
+        const Transaction& trans = updated.at(i);
+        analytics.removeTransaction(selected.at(i));
+        analytics.addTransaction(trans);
+
+        auto it = transactionRows.constFind(trans.id());
+        if (it != transactionRows.constEnd()) {
+            transactions.replace(it.value(), trans);
+        }
+        if (filterActive) {
+            filteredTransactions.replace(rows.at(i), trans);
+        }
+    }
+
+    // One repaint for the edited rows and one analytics refresh
+    transactionModel->rowsChanged(rows.first(), rows.last());
+    updateAnalytics();
 }
 
 void MainWindow::handleTransactionTableContextMenu(const QPoint& pos)
 {
-    QTableWidgetItem *item = transactionTable->itemAt(pos);
-    if (item) {
+    QModelIndex index = transactionTable->indexAt(pos);
+    if (index.isValid()) {
+        // Right-clicking outside the selection acts on the clicked row only
+        if (!transactionTable->selectionModel()->isRowSelected(index.row(), QModelIndex())) {
+            transactionTable->selectRow(index.row());
+        }
+        int count = transactionTable->selectionModel()->selectedRows().size();
+
         QMenu contextMenu(tr("Context menu"), this);
-        QAction *deleteAction = contextMenu.addAction("Delete Transaction");
+        QAction *editAction = contextMenu.addAction(count > 1 ? QString("Change Category of %1 Transactions...").arg(count)
+                                                              : QString("Change Category..."));
+        QAction *deleteAction = contextMenu.addAction(count > 1 ? QString("Delete %1 Transactions").arg(count)
+                                                                : QString("Delete Transaction"));
 
-        if (contextMenu.exec(transactionTable->viewport()->mapToGlobal(pos)) == deleteAction) {
+        QAction *chosen = contextMenu.exec(transactionTable->viewport()->mapToGlobal(pos));
+        if (chosen == deleteAction) {
             deleteSelectedTransaction();
+        } else if (chosen == editAction) {
+            editSelectedCategory();
         }
     }
 }
@@ -1053,8 +1534,6 @@ void MainWindow::setupFilters()
     searchEdit->setPlaceholderText("Search transactions...");
 
     categoryFilter = new QComboBox;
-    categoryFilter->addItems({"All Categories", "Salary", "Food", "Transport",
-                              "Entertainment", "Bills", "Shopping", "Other"});
 
     minAmountFilter = new QLineEdit;
     maxAmountFilter = new QLineEdit;
@@ -1088,55 +1567,51 @@ void MainWindow::setupFilters()
     connect(clearFiltersButton, &QPushButton::clicked, this, &MainWindow::clearFilters);
     connect(searchEdit, &QLineEdit::textChanged, this, &MainWindow::searchTransactions);
 
+    searchDebounceTimer = new QTimer(this);
+    searchDebounceTimer->setSingleShot(true);
+    searchDebounceTimer->setInterval(250);
+    connect(searchDebounceTimer, &QTimer::timeout, this, &MainWindow::updateTransactionTable);
+
     QVBoxLayout *pageLayout = qobject_cast<QVBoxLayout*>(transactionsPage->layout());
     pageLayout->insertWidget(1, filterGroup);
 }
 
-QVector<Transaction> MainWindow::getFilteredTransactions()
+void MainWindow::refreshCategoryLists()
 {
-    QVector<Transaction> filtered;
-    QString searchText = searchEdit->text().toLower();
-    QString category = categoryFilter->currentText();
-    double minAmount = minAmountFilter->text().toDouble();
-    double maxAmount = maxAmountFilter->text().toDouble();
-    QDate startDate = startDateFilter->date();
-    QDate endDate = endDateFilter->date();
-
-    for (const Transaction& trans : transactions) {
-        bool matches = true;
-
-        // Search text filter
-        if (!searchText.isEmpty()) {
-            bool matchesSearch = trans.description().toLower().contains(searchText) ||
-                                 trans.category().toLower().contains(searchText);
-            if (!matchesSearch) matches = false;
-        }
-
-        // Category filter
-        if (category != "All Categories" && trans.category() != category) {
-            matches = false;
-        }
+    // Item data carries the category id; the current choices survive a refresh
+    int selectedCategory = categoryCombo->currentData().toInt();
+    int filteredCategory = categoryFilter->currentIndex() > 0 ? categoryFilter->currentData().toInt() : -1;
+
+    const CategoryDictionary& categories = dbManager.categories();
+    categoryCombo->clear();
+    categoryFilter->clear();
+    categoryFilter->addItem("All Categories", -1);
+    for (int id : categories.categoryIds()) {
+        categoryCombo->addItem(categories.name(id), id);
+        categoryFilter->addItem(categories.name(id), id);
+    }
 
-        // Amount filter
-        if (!minAmountFilter->text().isEmpty() && std::abs(trans.amount()) < minAmount) {
-            matches = false;
-        }
-        if (!maxAmountFilter->text().isEmpty() && std::abs(trans.amount()) > maxAmount) {
-            matches = false;
-        }
+    categoryCombo->setCurrentIndex(qMax(0, categoryCombo->findData(selectedCategory)));
+    categoryFilter->setCurrentIndex(qMax(0, categoryFilter->findData(filteredCategory)));
+}
 
-        // Date filter
-        QDate transDate = trans.datetime().date();
-        if (transDate < startDate || transDate > endDate) {
-            matches = false;
-        }
+TransactionFilter MainWindow::currentFilter() const
+{
+    TransactionFilter filter;
+    filter.searchText = searchEdit->text().trimmed();
 
-        if (matches) {
-            filtered.append(trans);
+    // The remaining criteria only take effect once "Apply Filters" is pressed
+    if (filtersApplied) {
+        if (categoryFilter->currentIndex() > 0) {
+            filter.categoryId = categoryFilter->currentData().toInt();
         }
+        filter.minAmount = Money::fromString(minAmountFilter->text(), &filter.hasMinAmount).abs();
+        filter.maxAmount = Money::fromString(maxAmountFilter->text(), &filter.hasMaxAmount).abs();
+        filter.startDate = startDateFilter->date();
+        filter.endDate = endDateFilter->date();
     }
 
-    return filtered;
+    return filter;
 }
 
 void MainWindow::cleanupCharts()
@@ -1144,8 +1619,8 @@ void MainWindow::cleanupCharts()
     if (expenseChartView) {
         delete expenseChartView->chart();
     }
-    if (monthlyComparisonChart) {
-        delete monthlyComparisonChart->chart();
+    if (periodComparisonChart) {
+        delete periodComparisonChart->chart();
     }
     if (balanceTrendChart) {
         delete balanceTrendChart->chart();
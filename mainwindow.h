@@ -8,9 +8,13 @@
 #include <QLineEdit> //Single line box where user can input stuff, like the amount or description
 #include <QComboBox>
 #include <QDateTimeEdit>
-#include <QTableWidget>
+#include <QTableView>
 #include <QVector>
+#include <QHash>
+#include <QSet>
 #include <QShortcut>
+#include <QThread>
+#include <QTimer>
 #include <QMessageBox>
 #include <QMenu>
 #include <QMenuBar>
@@ -30,6 +34,16 @@
 
 #include "transaction.h"
 #include "databasemanager.h"
+#include "transactionstore.h"
+#include "transactiontablemodel.h"
+#include "analyticsstore.h"
+#include "searchworker.h"
+#include "transactionloader.h"
+#include "writebehindqueue.h"
+#include "transactionimporter.h"
+#include "csvexporter.h"
+#include "pdfreportrenderer.h"
+#include "xlsxexporter.h"
 
 class MainWindow : public QMainWindow
 {
@@ -52,23 +66,50 @@ private slots:
     void applyFilters();
     void clearFilters();
     void deleteSelectedTransaction();
+    void editSelectedCategory();
     void handleTransactionTableContextMenu(const QPoint& pos);
     void showShortcutsDialog();
     void newTransactionShortcutTriggered();
     void focusSearchBox();
+    void importTransactions();
     void exportToCSV();
     void exportToPDF();
     void exportToExcel();
     void updateAnalytics();
+    void appendSearchResults(quint64 generation, const QVector<Transaction>& batch);
+    void appendLoadedTransactions(quint64 generation, const QVector<Transaction>& chunk);
+    void finishLoading(quint64 generation);
+    void rollBackFailedWrites(const QVector<Transaction>& inserted, const QVector<Transaction>& removed,
+                              const QString& error);
 
 private:
     DatabaseManager dbManager;
 
     // Charts
     QChartView *expenseChartView;
-    QChartView *monthlyComparisonChart;
+    QChartView *periodComparisonChart;
     QChartView *balanceTrendChart;
 
+    // Chart series and axes, updated in place by updateAnalytics()
+    QPieSeries *expensePieSeries;
+    QHash<int, QPieSlice*> categorySlices;  // Keyed by category id
+    QBarSet *periodIncomeSet;
+    QBarSet *periodExpenseSet;
+    QBarCategoryAxis *periodAxis;
+    QValueAxis *periodValueAxis;
+    QComboBox *periodCombo;  // DateBucket granularity of the bar chart
+    QLineSeries *balanceSeries;
+    QDateTimeAxis *balanceTimeAxis;
+    QValueAxis *balanceValueAxis;
+    // Lowest and highest balance up to each point of balanceSeries
+    QVector<double> balanceLows;
+    QVector<double> balanceHighs;
+
+    // Analytics overview labels
+    QLabel *analyticsIncomeLabel;
+    QLabel *analyticsExpensesLabel;
+    QLabel *analyticsBalanceLabel;
+
     // Navigation buttons
     QPushButton *dashboardButton;
     QPushButton *transactionsButton;
@@ -93,7 +134,8 @@ private:
     QPushButton *clearButton;
 
     // Transaction table
-    QTableWidget *transactionTable;
+    QTableView *transactionTable;
+    TransactionTableModel *transactionModel;
 
     // Balance labels
     QLabel *balanceLabel;
@@ -110,6 +152,25 @@ private:
     QPushButton *applyFiltersButton;
     QPushButton *clearFiltersButton;
 
+    // Background loading
+    QThread *loaderThread;
+    TransactionLoader *transactionLoader;
+    QTimer *analyticsRefreshTimer;
+    quint64 loadGeneration = 0;
+
+    // Exports running on their own threads
+    QHash<QThread*, ExportWorker*> activeExports;
+
+    // Asynchronous search
+    QThread *searchThread;
+    SearchWorker *searchWorker;
+    QTimer *searchDebounceTimer;
+    quint64 searchGeneration = 0;
+
+    // Form inserts and deletes, committed in groups on their own thread
+    QThread *writerThread;
+    WriteBehindQueue *writeQueue;
+
     // Keyboard shortcuts
     QShortcut *newTransactionShortcut;
     QShortcut *deleteTransactionShortcut;
@@ -117,13 +178,19 @@ private:
     QShortcut *refreshShortcut;
 
     // Data
-    QVector<Transaction> transactions;
-    double currentBalance;
-    double totalIncome;
-    double totalExpenses;
+    TransactionStore transactions;
+    QHash<qint64, int> transactionRows;  // Transaction id -> index in transactions
+    TransactionStore filteredTransactions;  // Rows shown while a filter is active
+    bool filterActive = false;
+    bool filtersApplied = false;
+    AnalyticsStore analytics;
+    Money currentBalance;
+    Money totalIncome;
+    Money totalExpenses;
 
     // Private methods
     void setupUI();
+    void setupWorkers();
     void setupNavigation();
     void setupDashboard();
     void setupTransactionsPage();
@@ -134,7 +201,12 @@ private:
     void setTheme(bool darkTheme);
     void cleanupCharts();
     void loadTransactionsFromDatabase();
-    QVector<Transaction> getFilteredTransactions();
+    void startExport(ExportWorker *exporter, const QString& label, int expectedRows);
+    void appendStoredTransactions(const QVector<Transaction>& newTransactions);
+    void removeStoredTransactions(const QSet<qint64>& ids);
+    QVector<Transaction> selectedTransactions(QList<int> *rows = nullptr) const;
+    TransactionFilter currentFilter() const;
+    void refreshCategoryLists();
     bool isDarkTheme = false;
 };
 
@@ -0,0 +1,42 @@
+#include "money.h"
+#include <limits>
+
+Money Money::fromString(const QString& text, bool *ok)
+{
+    if (ok)
+        *ok = false;
+
+    QString trimmed = text.trimmed();
+    trimmed.remove(u'$').remove(u',').remove(u' ');
+
+    bool negative = false;
+    if (trimmed.startsWith(u'-') || trimmed.startsWith(u'+')) {
+        negative = trimmed.startsWith(u'-');
+        trimmed.remove(0, 1);
+    }
+
+    qsizetype point = trimmed.indexOf(u'.');
+    QString whole = point < 0 ? trimmed : trimmed.left(point);
+    QString fraction = point < 0 ? QString() : trimmed.mid(point + 1);
+    if ((whole.isEmpty() && fraction.isEmpty()) || fraction.size() > 2)
+        return Money();
+
+    qint64 cents = 0;
+    for (QChar c : whole + fraction.leftJustified(2, u'0')) {
+        if (!c.isDigit() || cents > (std::numeric_limits<qint64>::max() - 9) / 10)
+            return Money();
+        cents = cents * 10 + c.digitValue();
+    }
+
+    if (ok)
+        *ok = true;
+    return Money(negative ? -cents : cents);
+}
+
+QString Money::toString() const
+{
+    qint64 magnitude = value < 0 ? -value : value;
+    return QString("%1%2.%3").arg(value < 0 ? "-" : "")
+                             .arg(magnitude / 100)
+                             .arg(magnitude % 100, 2, 10, QChar('0'));
+}
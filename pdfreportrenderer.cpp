@@ -0,0 +1,189 @@
+#include "pdfreportrenderer.h"
+#include <QPrinter>
+#include <QPainter>
+#include <QFontMetricsF>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlError>
+#include <QDateTime>
+#include <QFile>
+
+// Relative column widths: Date, Type, Amount, Description, Category
+static const qreal columnWidths[] = { 0.16, 0.10, 0.12, 0.42, 0.20 };
+static const char *columnTitles[] = { "Date", "Type", "Amount", "Description", "Category" };
+static const int columnCount = 5;
+
+PdfReportRenderer::PdfReportRenderer(ConnectionPool *connections, const QString& fileName,
+                                     const TransactionFilter& filter, bool useFullTextSearch,
+                                     const Summary& summary, QObject *parent)
+    : ExportWorker(connections, parent)
+    , fileName(fileName)
+    , filter(filter)
+    , useFullTextSearch(useFullTextSearch)
+    , summary(summary)
+{
+}
+
+qreal PdfReportRenderer::drawTableHeader(QPainter& painter, const QRectF& pageRect, qreal top, qreal rowHeight)
+{
+    QRectF headerRect(pageRect.left(), top, pageRect.width(), rowHeight);
+    painter.fillRect(headerRect, QColor("#f0f0f0"));
+
+    QFont font = painter.font();
+    font.setBold(true);
+    painter.setFont(font);
+
+    qreal x = pageRect.left();
+    for (int column = 0; column < columnCount; ++column) {
+        qreal width = pageRect.width() * columnWidths[column];
+        painter.drawText(QRectF(x + rowHeight * 0.2, top, width - rowHeight * 0.4, rowHeight),
+                         Qt::AlignVCenter | (column == 2 ? Qt::AlignRight : Qt::AlignLeft),
+                         columnTitles[column]);
+        x += width;
+    }
+
+    font.setBold(false);
+    painter.setFont(font);
+    return top + rowHeight;
+}
+
+void PdfReportRenderer::drawPageFooter(QPainter& painter, const QRectF& pageRect, qreal rowHeight, int page,
+                                       Money pageIncome, Money pageExpenses)
+{
+    qreal top = pageRect.bottom() - rowHeight * 2;
+    painter.drawLine(QPointF(pageRect.left(), top), QPointF(pageRect.right(), top));
+
+    QString subtotal = QString("Page subtotal  -  Income: $%1   Expenses: $%2   Net: $%3")
+                           .arg(pageIncome.toString())
+                           .arg(pageExpenses.toString())
+                           .arg((pageIncome - pageExpenses).toString());
+    painter.drawText(QRectF(pageRect.left(), top, pageRect.width(), rowHeight),
+                     Qt::AlignVCenter | Qt::AlignLeft, subtotal);
+    painter.drawText(QRectF(pageRect.left(), top + rowHeight, pageRect.width(), rowHeight),
+                     Qt::AlignVCenter | Qt::AlignRight, QString("Page %1").arg(page));
+}
+
+bool PdfReportRenderer::exportData(QSqlDatabase& db, QString *message, QString *error)
+{
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!DatabaseManager::prepareFilterQuery(query, filter, useFullTextSearch) || !query.exec()) {
+        *error = "Could not read transactions: " + query.lastError().text();
+        return false;
+    }
+
+    QPrinter printer(QPrinter::HighResolution);
+    printer.setOutputFormat(QPrinter::PdfFormat);
+    printer.setOutputFileName(fileName);
+    printer.setPageOrientation(QPageLayout::Landscape);
+
+    QPainter painter;
+    if (!painter.begin(&printer)) {
+        *error = "Could not open file for writing.";
+        return false;
+    }
+
+    QRectF pageRect(QPointF(0, 0), QSizeF(printer.pageLayout().paintRectPixels(printer.resolution()).size()));
+    QFont font("Helvetica", 9);
+    painter.setFont(font);
+    QFontMetricsF metrics(font, &printer);
+    qreal rowHeight = metrics.height() * 1.6;
+    qreal rowsBottom = pageRect.bottom() - rowHeight * 2.5;
+
+    // Title and summary on the first page
+    QFont titleFont = font;
+    titleFont.setPointSize(16);
+    titleFont.setBold(true);
+    painter.setFont(titleFont);
+    qreal top = pageRect.top();
+    painter.drawText(QRectF(pageRect.left(), top, pageRect.width(), rowHeight * 2),
+                     Qt::AlignVCenter | Qt::AlignLeft, "Finance Tracker - Transaction Report");
+    top += rowHeight * 2;
+    painter.setFont(font);
+
+    const QStringList summaryLines = {
+        "Generated on: " + QDateTime::currentDateTime().toString(),
+        QString("Total Income: $%1").arg(summary.totalIncome.toString()),
+        QString("Total Expenses: $%1").arg(summary.totalExpenses.toString()),
+        QString("Current Balance: $%1").arg(summary.currentBalance.toString())
+    };
+    for (const QString& line : summaryLines) {
+        painter.drawText(QRectF(pageRect.left(), top, pageRect.width(), rowHeight),
+                         Qt::AlignVCenter | Qt::AlignLeft, line);
+        top += rowHeight;
+    }
+    top += rowHeight;
+
+    QSqlRecord record = query.record();
+    int datetimeColumn = record.indexOf("datetime_ms");
+    int typeColumn = record.indexOf("type");
+    int amountColumn = record.indexOf("amount_cents");
+    int descriptionColumn = record.indexOf("description");
+    int categoryColumn = record.indexOf("category");
+
+    int page = 1;
+    int rows = 0;
+    Money pageIncome;
+    Money pageExpenses;
+    top = drawTableHeader(painter, pageRect, top, rowHeight);
+
+    while (query.next()) {
+        if (top + rowHeight > rowsBottom) {
+            drawPageFooter(painter, pageRect, rowHeight, page, pageIncome, pageExpenses);
+            if (!printer.newPage()) {
+                *error = "Could not start a new page.";
+                return false;
+            }
+            ++page;
+            pageIncome = Money();
+            pageExpenses = Money();
+            top = drawTableHeader(painter, pageRect, pageRect.top(), rowHeight);
+        }
+
+        bool income = query.value(typeColumn).toInt() == Transaction::Income;
+        Money amount = Money::fromCents(query.value(amountColumn).toLongLong()).abs();
+        if (income)
+            pageIncome += amount;
+        else
+            pageExpenses += amount;
+
+        QDateTime datetime = QDateTime::fromMSecsSinceEpoch(query.value(datetimeColumn).toLongLong());
+        const QString cells[columnCount] = {
+            datetime.toString("yyyy-MM-dd hh:mm"),
+            income ? QStringLiteral("Income") : QStringLiteral("Expense"),
+            "$" + amount.toString(),
+            query.value(descriptionColumn).toString(),
+            query.value(categoryColumn).toString()
+        };
+
+        qreal x = pageRect.left();
+        for (int column = 0; column < columnCount; ++column) {
+            qreal width = pageRect.width() * columnWidths[column];
+            qreal textWidth = width - rowHeight * 0.4;
+            painter.drawText(QRectF(x + rowHeight * 0.2, top, textWidth, rowHeight),
+                             Qt::AlignVCenter | (column == 2 ? Qt::AlignRight : Qt::AlignLeft),
+                             metrics.elidedText(cells[column], Qt::ElideRight, textWidth));
+            x += width;
+        }
+        painter.setPen(QColor("#d0d0d0"));
+        painter.drawLine(QPointF(pageRect.left(), top + rowHeight), QPointF(pageRect.right(), top + rowHeight));
+        painter.setPen(Qt::black);
+        top += rowHeight;
+
+        if (++rows % ProgressInterval == 0) {
+            if (isCancelled()) {
+                painter.end();
+                QFile::remove(fileName);
+                return false;
+            }
+            reportProgress(rows);
+        }
+    }
+
+    drawPageFooter(painter, pageRect, rowHeight, page, pageIncome, pageExpenses);
+    painter.end();
+
+    reportProgress(rows);
+    *message = QString("Report with %1 transactions on %2 pages exported to PDF successfully!").arg(rows).arg(page);
+    return true;
+}
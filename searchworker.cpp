@@ -0,0 +1,76 @@
+#include "searchworker.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+
+SearchWorker::SearchWorker(ConnectionPool *connections, bool useFullTextSearch, QObject *parent)
+    : QObject(parent)
+    , connections(connections)
+    , useFullTextSearch(useFullTextSearch)
+    , latestGeneration(0)
+{
+    qRegisterMetaType<QVector<Transaction>>("QVector<Transaction>");
+}
+
+SearchWorker::~SearchWorker()
+{
+    // Runs on the worker thread, which owns the reader connection
+    db = QSqlDatabase();
+    connections->releaseReader();
+}
+
+void SearchWorker::cancelBefore(quint64 generation)
+{
+    latestGeneration.store(generation);
+}
+
+bool SearchWorker::isCancelled(quint64 generation) const
+{
+    return generation != latestGeneration.load(std::memory_order_relaxed);
+}
+
+bool SearchWorker::openConnection()
+{
+    if (db.isOpen())
+        return true;
+
+    // Asked for here so the connection belongs to the worker thread
+    db = connections->reader();
+    if (!db.isOpen()) {
+        qDebug() << "Error opening search connection:" << db.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+void SearchWorker::search(quint64 generation, const TransactionFilter& filter)
+{
+    // Requests that were superseded while queued are dropped unseen
+    if (isCancelled(generation) || !openConnection())
+        return;
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!DatabaseManager::prepareFilterQuery(query, filter, useFullTextSearch) || !query.exec()) {
+        qDebug() << "Error running search:" << query.lastError().text();
+        return;
+    }
+
+    QVector<Transaction> batch;
+    batch.reserve(BatchSize);
+    while (query.next()) {
+        if (isCancelled(generation))
+            return;
+
+        batch.append(DatabaseManager::transactionFromQuery(query));
+        if (batch.size() == BatchSize) {
+            emit resultsReady(generation, batch);
+            batch.clear();
+            batch.reserve(BatchSize);
+        }
+    }
+
+    if (!batch.isEmpty()) {
+        emit resultsReady(generation, batch);
+    }
+}
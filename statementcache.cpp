@@ -0,0 +1,55 @@
+#include "statementcache.h"
+#include <QDebug>
+#include <QSqlError>
+
+Q_LOGGING_CATEGORY(lcStatementCache, "financetracker.statementcache", QtInfoMsg)
+
+StatementCache::StatementCache(int capacity)
+    : queries(qMax(1, capacity))
+{
+}
+
+StatementCache::~StatementCache()
+{
+    clear();
+}
+
+void StatementCache::setDatabase(const QSqlDatabase& database)
+{
+    clear();
+    db = database;
+}
+
+void StatementCache::clear()
+{
+    queries.clear();
+}
+
+void StatementCache::logStatistics(const char *connection) const
+{
+    qCDebug(lcStatementCache) << connection << "statement cache:" << hitCount << "hits," << missCount << "misses,"
+                              << queries.size() << "cached";
+}
+
+QSqlQuery *StatementCache::prepare(const QString& sql)
+{
+    if (QSqlQuery *query = queries.object(sql)) {
+        ++hitCount;
+        // Resets the statement, so a previous SELECT no longer holds a read
+        query->finish();
+        return query;
+    }
+
+    ++missCount;
+    auto *query = new QSqlQuery(db);
+    // Cached results are only ever read front to back
+    query->setForwardOnly(true);
+    if (!query->prepare(sql)) {
+        qDebug() << "Error preparing statement:" << query->lastError().text();
+        delete query;
+        return nullptr;
+    }
+    // The cache takes ownership; the least recently used entry goes first
+    queries.insert(sql, query);
+    return query;
+}
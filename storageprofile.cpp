@@ -0,0 +1,111 @@
+#include "storageprofile.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFileInfo>
+#include <QSettings>
+#include <QSqlError>
+#include <QSqlQuery>
+
+StorageProfile StorageProfile::preset(const QString& name, bool *ok)
+{
+    StorageProfile profile;
+    QString key = name.trimmed().toLower();
+    if (ok)
+        *ok = true;
+
+    if (key == "safe") {
+        profile.name = "safe";
+        profile.journalMode = "DELETE";
+        profile.synchronous = "FULL";
+        profile.cacheSizeKiB = 2000;
+        profile.mmapSizeMiB = 0;
+        profile.tempStore = "DEFAULT";
+    } else if (key == "fast") {
+        profile.name = "fast";
+        profile.journalMode = "WAL";
+        profile.synchronous = "OFF";
+        profile.cacheSizeKiB = 262144;
+        profile.mmapSizeMiB = 1024;
+        profile.tempStore = "MEMORY";
+    } else if (key != "balanced" && ok) {
+        *ok = false;
+    }
+    return profile;
+}
+
+QString StorageProfile::configPath()
+{
+    return QCoreApplication::applicationDirPath() + "/finance_tracker.ini";
+}
+
+// Only values SQLite accepts are passed through, since they end up in SQL text
+static QString checkedValue(const QString& value, const QStringList& allowed, const QString& fallback)
+{
+    QString upper = value.trimmed().toUpper();
+    if (allowed.contains(upper))
+        return upper;
+    qDebug() << "Ignoring storage setting" << value << "- expected one of" << allowed;
+    return fallback;
+}
+
+StorageProfile StorageProfile::load(const QString& path)
+{
+    if (!QFileInfo::exists(path))
+        return preset("balanced");
+
+    QSettings settings(path, QSettings::IniFormat);
+    settings.beginGroup("storage");
+
+    bool ok = false;
+    QString presetName = settings.value("profile", "balanced").toString();
+    StorageProfile profile = preset(presetName, &ok);
+    if (!ok)
+        qDebug() << "Unknown storage profile" << presetName << "- using balanced";
+
+    profile.journalMode = checkedValue(settings.value("journal_mode", profile.journalMode).toString(),
+                                       {"WAL", "DELETE", "TRUNCATE", "PERSIST", "MEMORY"}, profile.journalMode);
+    profile.synchronous = checkedValue(settings.value("synchronous", profile.synchronous).toString(),
+                                       {"OFF", "NORMAL", "FULL", "EXTRA"}, profile.synchronous);
+    profile.tempStore = checkedValue(settings.value("temp_store", profile.tempStore).toString(),
+                                     {"DEFAULT", "FILE", "MEMORY"}, profile.tempStore);
+    profile.cacheSizeKiB = qMax(0, settings.value("cache_size_kib", profile.cacheSizeKiB).toInt());
+    profile.mmapSizeMiB = qMax(0, settings.value("mmap_size_mib", profile.mmapSizeMiB).toInt());
+    profile.busyTimeoutMs = qMax(0, settings.value("busy_timeout_ms", profile.busyTimeoutMs).toInt());
+
+    settings.endGroup();
+    return profile;
+}
+
+QString StorageProfile::connectOptions(bool readOnly) const
+{
+    QString options = QString("QSQLITE_BUSY_TIMEOUT=%1").arg(busyTimeoutMs);
+    if (readOnly)
+        options += ";QSQLITE_OPEN_READONLY";
+    return options;
+}
+
+QStringList StorageProfile::pragmas(bool readOnly) const
+{
+    QStringList statements;
+    if (!readOnly)
+        statements << "PRAGMA journal_mode = " + journalMode;
+    // A negative cache_size is in KiB rather than pages
+    statements << "PRAGMA synchronous = " + synchronous
+               << QString("PRAGMA cache_size = -%1").arg(cacheSizeKiB)
+               << QString("PRAGMA mmap_size = %1").arg(qint64(mmapSizeMiB) * 1024 * 1024)
+               << "PRAGMA temp_store = " + tempStore;
+    return statements;
+}
+
+bool StorageProfile::apply(QSqlDatabase& db, bool readOnly) const
+{
+    QSqlQuery query(db);
+    bool ok = true;
+    for (const QString& statement : pragmas(readOnly)) {
+        if (!query.exec(statement)) {
+            qDebug() << "Error applying" << statement << ":" << query.lastError().text();
+            ok = false;
+        }
+    }
+    return ok;
+}
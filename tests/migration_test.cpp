@@ -0,0 +1,299 @@
+// Upgrades fixture databases in every earlier schema layout through
+// DatabaseManager::initialize() and checks that no row, cent or
+// millisecond is lost. Built only with -DMODERNFINANCETRACKER_BUILD_TESTS=ON.
+
+#include "databasemanager.h"
+#include "datebucket.h"
+
+#include <QMap>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QtTest>
+
+namespace {
+
+// Enough rows for the interrupted copy to span several migration chunks
+constexpr int LargeFixtureRows = DatabaseManager::MigrationChunkSize * 2 + 20000;
+constexpr int SmallFixtureRows = 500;
+
+const QStringList categoryNames = {"Salary", "Food", "Groceries", "Other"};
+
+struct Row {
+    qint64 id;
+    int type;
+    qint64 cents;              // Signed: expenses are negative
+    QString description;
+    int category;              // Index into categoryNames
+    QDateTime datetime;        // Local, whole seconds, as the text layouts kept it
+};
+
+// Ids with gaps of several sizes, cent values that binary floating point
+// cannot hold exactly, and dates on both sides of month boundaries. Times
+// stay clear of the early hours, which daylight saving can skip.
+QVector<Row> fixtureRows(int count)
+{
+    QVector<Row> rows;
+    rows.reserve(count);
+    qint64 id = 0;
+    for (int i = 0; i < count; ++i) {
+        id += 1;
+        if (i % 7 == 3)
+            id += 2;
+        if (i % 1000 == 999)
+            id += 5000;
+
+        bool expense = i % 3 != 0;
+        qint64 cents = qint64(i) * 7919 % 1000000 + 1;
+        QDateTime datetime(QDate(2000, 1, 1).addDays(i / 4), QTime(8 + i % 4 * 4, 15, 59));
+        rows.append({id, expense ? 1 : 0, expense ? -cents : cents, QString("Row %1").arg(i),
+                     i % categoryNames.size(), datetime});
+    }
+    return rows;
+}
+
+bool exec(QSqlQuery& query, const QString& sql)
+{
+    if (query.exec(sql))
+        return true;
+    qWarning() << "Fixture error:" << sql << query.lastError().text();
+    return false;
+}
+
+// Table layout of each schema version before month_key was stored:
+// 0 text categories, 1 category ids, 2 integer cents, 3 epoch milliseconds
+QString createTableSql(int layout, const QString& name)
+{
+    return "CREATE TABLE " + name + " ("
+           "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+           "type INTEGER NOT NULL,"
+           + QString(layout < 2 ? "amount REAL NOT NULL," : "amount_cents INTEGER NOT NULL,")
+           + "description TEXT,"
+           + QString(layout < 1 ? "category TEXT," : "category_id INTEGER NOT NULL REFERENCES categories(id),")
+           + QString(layout < 3 ? "datetime TEXT NOT NULL" : "datetime_ms INTEGER NOT NULL")
+           + ")";
+}
+
+// Writes rows the way the build that used the layout did
+bool insertRows(QSqlQuery& query, int layout, const QString& table, const QVector<Row>& rows)
+{
+    QString sql = QString("INSERT INTO %1 (id, type, %2, description, %3, %4) VALUES (?, ?, ?, ?, ?, ?)")
+                      .arg(table, layout < 2 ? "amount" : "amount_cents", layout < 1 ? "category" : "category_id",
+                           layout < 3 ? "datetime" : "datetime_ms");
+    if (!query.prepare(sql)) {
+        qWarning() << "Fixture error:" << sql << query.lastError().text();
+        return false;
+    }
+
+    QVariantList ids, types, amounts, descriptions, categories, datetimes;
+    for (const Row& row : rows) {
+        ids << row.id;
+        types << row.type;
+        amounts << (layout < 2 ? QVariant(row.cents / 100.0) : QVariant(row.cents));
+        descriptions << row.description;
+        // The first builds left the category empty for "Other"
+        if (layout < 1)
+            categories << (categoryNames.at(row.category) == "Other" ? QString() : categoryNames.at(row.category));
+        else
+            categories << row.category + 1;
+        datetimes << (layout < 3 ? QVariant(row.datetime.toString(Qt::ISODate))
+                                 : QVariant(row.datetime.toMSecsSinceEpoch()));
+    }
+    query.addBindValue(ids);
+    query.addBindValue(types);
+    query.addBindValue(amounts);
+    query.addBindValue(descriptions);
+    query.addBindValue(categories);
+    query.addBindValue(datetimes);
+    if (!query.execBatch()) {
+        qWarning() << "Fixture error:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+// A database as a build with the given layout left it. With copiedRows,
+// the step to the next layout was interrupted after that many rows.
+bool fillFixture(QSqlDatabase& db, int layout, int userVersion, const QVector<Row>& rows, int copiedRows)
+{
+    QSqlQuery query(db);
+    if (!db.transaction())
+        return false;
+
+    if (layout >= 1) {
+        if (!exec(query, "CREATE TABLE categories (id INTEGER PRIMARY KEY, name TEXT NOT NULL UNIQUE)"))
+            return false;
+        for (int i = 0; i < categoryNames.size(); ++i) {
+            if (!exec(query, QString("INSERT INTO categories (id, name) VALUES (%1, '%2')")
+                                 .arg(i + 1).arg(categoryNames.at(i))))
+                return false;
+        }
+    }
+
+    if (!exec(query, createTableSql(layout, "transactions"))
+        || !insertRows(query, layout, "transactions", rows))
+        return false;
+
+    if (copiedRows > 0) {
+        if (!exec(query, createTableSql(layout + 1, "transactions_migrated"))
+            || !insertRows(query, layout + 1, "transactions_migrated", rows.mid(0, copiedRows)))
+            return false;
+    }
+
+    return exec(query, QString("PRAGMA user_version = %1").arg(userVersion)) && db.commit();
+}
+
+bool writeFixture(const QString& path, int layout, int userVersion, const QVector<Row>& rows, int copiedRows = 0)
+{
+    bool ok;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "fixture");
+        db.setDatabaseName(path);
+        ok = db.open() && fillFixture(db, layout, userVersion, rows, copiedRows);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase("fixture");
+    return ok;
+}
+
+qint64 monthKey(qint64 msecs)
+{
+    return DateBucket::key(DateBucket::Month, QDateTime::fromMSecsSinceEpoch(msecs).date().toJulianDay());
+}
+
+} // namespace
+
+class MigrationTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void migratesVersion0();
+    void migratesVersion1();
+    void migratesVersion2();
+    void migratesVersion3();
+    void resumesInterruptedCopy();
+    void continuesIdsAfterGaps();
+
+private:
+    void migrate(int layout, int userVersion, const QVector<Row>& rows, int copiedRows = 0);
+    void checkMigrated(QSqlDatabase& db, const QVector<Row>& rows);
+
+    QTemporaryDir dir;
+};
+
+void MigrationTest::migrate(int layout, int userVersion, const QVector<Row>& rows, int copiedRows)
+{
+    QString path = dir.filePath(QString("%1.db").arg(QTest::currentTestFunction()));
+    QVERIFY(writeFixture(path, layout, userVersion, rows, copiedRows));
+
+    {
+        DatabaseManager manager;
+        QVERIFY(manager.initialize(path));
+    }
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "check");
+        db.setDatabaseName(path);
+        QVERIFY(db.open());
+        checkMigrated(db, rows);
+    }
+    QSqlDatabase::removeDatabase("check");
+}
+
+void MigrationTest::checkMigrated(QSqlDatabase& db, const QVector<Row>& rows)
+{
+    QSqlQuery query(db);
+    QVERIFY(query.exec("PRAGMA user_version") && query.next());
+    QCOMPARE(query.value(0).toInt(), DatabaseManager::SchemaVersion);
+
+    QVERIFY(query.exec("SELECT 1 FROM sqlite_master WHERE name = 'transactions_migrated'"));
+    QVERIFY(!query.next());
+
+    // Every row keeps its id, exact cents and instant
+    QMap<QString, QPair<qint64, int>> summary;
+    QVERIFY(query.exec("SELECT t.id, t.type, t.amount_cents, t.description, c.name, t.datetime_ms, t.month_key "
+                       "FROM transactions t JOIN categories c ON c.id = t.category_id ORDER BY t.id"));
+    for (const Row& row : rows) {
+        QVERIFY(query.next());
+        QCOMPARE(query.value(0).toLongLong(), row.id);
+        QCOMPARE(query.value(1).toInt(), row.type);
+        QCOMPARE(query.value(2).toLongLong(), row.cents);
+        QCOMPARE(query.value(3).toString(), row.description);
+        QCOMPARE(query.value(4).toString(), categoryNames.at(row.category));
+        QCOMPARE(query.value(5).toLongLong(), row.datetime.toMSecsSinceEpoch());
+        QCOMPARE(query.value(6).toLongLong(), monthKey(row.datetime.toMSecsSinceEpoch()));
+
+        QPair<qint64, int>& total = summary[QString("%1/%2/%3").arg(query.value(6).toLongLong())
+                                                .arg(categoryNames.at(row.category)).arg(row.type)];
+        total.first += qAbs(row.cents);
+        total.second += 1;
+    }
+    QVERIFY(!query.next());
+
+    // The summary matches the rows it was built from
+    QVERIFY(query.exec("SELECT s.month, c.name, s.type, s.total_cents, s.row_count "
+                       "FROM transaction_summary s JOIN categories c ON c.id = s.category_id"));
+    int summaryRows = 0;
+    while (query.next()) {
+        QString key = QString("%1/%2/%3").arg(query.value(0).toLongLong()).arg(query.value(1).toString())
+                          .arg(query.value(2).toInt());
+        QVERIFY2(summary.contains(key), qPrintable(key));
+        QCOMPARE(query.value(3).toLongLong(), summary.value(key).first);
+        QCOMPARE(query.value(4).toInt(), summary.value(key).second);
+        ++summaryRows;
+    }
+    QCOMPARE(summaryRows, summary.size());
+}
+
+void MigrationTest::migratesVersion0()
+{
+    // Unversioned builds never set user_version; the layout tells them apart
+    migrate(0, 0, fixtureRows(SmallFixtureRows));
+}
+
+void MigrationTest::migratesVersion1()
+{
+    migrate(1, 0, fixtureRows(SmallFixtureRows));
+}
+
+void MigrationTest::migratesVersion2()
+{
+    migrate(2, 0, fixtureRows(SmallFixtureRows));
+}
+
+void MigrationTest::migratesVersion3()
+{
+    migrate(3, 3, fixtureRows(SmallFixtureRows));
+}
+
+void MigrationTest::resumesInterruptedCopy()
+{
+    // The date conversion stopped after its first committed chunk
+    migrate(2, 2, fixtureRows(LargeFixtureRows), DatabaseManager::MigrationChunkSize);
+}
+
+void MigrationTest::continuesIdsAfterGaps()
+{
+    QVector<Row> rows = fixtureRows(SmallFixtureRows);
+    migrate(2, 0, rows);
+    if (QTest::currentTestFailed())
+        return;
+
+    DatabaseManager manager;
+    QVERIFY(manager.initialize(dir.filePath("continuesIdsAfterGaps.db")));
+    Transaction transaction(Transaction::Expense, Money::fromCents(-1999), "After migration",
+                            manager.categoryId("Food"), QDateTime::currentDateTime());
+    QCOMPARE(manager.addTransactions({transaction}), 1);
+
+    QSqlQuery query(manager.connections().writer());
+    QVERIFY(query.exec("SELECT id, month_key FROM transactions WHERE description = 'After migration'"));
+    QVERIFY(query.next());
+    QVERIFY(query.value(0).toLongLong() > rows.last().id);
+    QCOMPARE(query.value(1).toLongLong(), transaction.monthKey());
+}
+
+QTEST_GUILESS_MAIN(MigrationTest)
+
+#include "migration_test.moc"
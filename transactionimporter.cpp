@@ -0,0 +1,234 @@
+#include "transactionimporter.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QRegularExpression>
+
+bool TransactionImporter::readFile(const QString& fileName)
+{
+    importedTransactions.clear();
+    skipped = 0;
+    error.clear();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        error = file.errorString();
+        return false;
+    }
+
+    QTextStream in(&file);
+    QString suffix = QFileInfo(fileName).suffix().toLower();
+    if (suffix == "ofx" || suffix == "qfx") {
+        return readOfx(in);
+    }
+    return readCsv(in);
+}
+
+// Reads one CSV record, following quoted fields across line breaks
+bool TransactionImporter::readCsvRecord(QTextStream& in, QStringList& fields)
+{
+    fields.clear();
+    if (in.atEnd())
+        return false;
+
+    QString field;
+    bool inQuotes = false;
+    QString line = in.readLine();
+
+    forever {
+        for (int i = 0; i < line.size(); ++i) {
+            QChar c = line.at(i);
+            if (inQuotes) {
+                if (c == '"') {
+                    if (i + 1 < line.size() && line.at(i + 1) == '"') {
+                        field += '"';
+                        ++i;
+                    } else {
+                        inQuotes = false;
+                    }
+                } else {
+                    field += c;
+                }
+            } else if (c == '"') {
+                inQuotes = true;
+            } else if (c == ',') {
+                fields << field.trimmed();
+                field.clear();
+            } else {
+                field += c;
+            }
+        }
+
+        if (!inQuotes || in.atEnd())
+            break;
+        field += '\n';
+        line = in.readLine();
+    }
+
+    fields << field.trimmed();
+    return true;
+}
+
+// Exact when the statement has at most two decimals; anything finer is
+// rounded to the nearest cent
+Money TransactionImporter::parseAmount(const QString& text, bool *ok)
+{
+    Money amount = Money::fromString(text, ok);
+    if (!*ok) {
+        QString cleaned = text;
+        cleaned.remove('$').remove(',').remove(' ');
+        amount = Money::fromDouble(cleaned.toDouble(ok));
+    }
+    return amount;
+}
+
+QDateTime TransactionImporter::parseDate(const QString& text)
+{
+    static const QStringList formats = {
+        "yyyy-MM-dd hh:mm", "yyyy-MM-dd hh:mm:ss", "yyyy-MM-dd",
+        "dd/MM/yyyy hh:mm", "dd/MM/yyyy", "MM/dd/yyyy", "dd.MM.yyyy"
+    };
+
+    QDateTime datetime = QDateTime::fromString(text, Qt::ISODate);
+    for (int i = 0; !datetime.isValid() && i < formats.size(); ++i) {
+        datetime = QDateTime::fromString(text, formats.at(i));
+    }
+    return datetime;
+}
+
+bool TransactionImporter::readCsv(QTextStream& in)
+{
+    QStringList header;
+    if (!readCsvRecord(in, header)) {
+        error = "The file is empty.";
+        return false;
+    }
+
+    // Map columns by header name so bank layouts work without configuration
+    int dateColumn = -1, typeColumn = -1, amountColumn = -1;
+    int descriptionColumn = -1, categoryColumn = -1;
+    for (int i = 0; i < header.size(); ++i) {
+        QString name = header.at(i).toLower();
+        if (dateColumn < 0 && name.contains("date"))
+            dateColumn = i;
+        else if (typeColumn < 0 && name == "type")
+            typeColumn = i;
+        else if (amountColumn < 0 && name.contains("amount"))
+            amountColumn = i;
+        else if (descriptionColumn < 0 && (name.contains("description") || name == "memo" || name == "name" || name == "payee"))
+            descriptionColumn = i;
+        else if (categoryColumn < 0 && name.contains("category"))
+            categoryColumn = i;
+    }
+
+    if (dateColumn < 0 || amountColumn < 0) {
+        error = "The CSV header needs at least a date and an amount column.";
+        return false;
+    }
+
+    QStringList fields;
+    while (readCsvRecord(in, fields)) {
+        if (fields.size() == 1 && fields.first().isEmpty())
+            continue;  // Blank line
+
+        bool ok = false;
+        QString amountText = fields.value(amountColumn);
+        Money amount = parseAmount(amountText, &ok);
+        QDateTime datetime = parseDate(fields.value(dateColumn));
+        if (!ok || !datetime.isValid()) {
+            ++skipped;
+            continue;
+        }
+
+        // An explicit type column wins; otherwise the sign decides
+        Transaction::Type type = amount.isNegative() ? Transaction::Expense : Transaction::Income;
+        if (typeColumn >= 0) {
+            QString typeText = fields.value(typeColumn).toLower();
+            if (typeText == "income" || typeText == "credit")
+                type = Transaction::Income;
+            else if (typeText == "expense" || typeText == "debit")
+                type = Transaction::Expense;
+        }
+
+        // Expenses are stored negative, matching addNewTransaction()
+        amount = amount.abs();
+        if (type == Transaction::Expense)
+            amount = -amount;
+
+        // An empty name maps to "Other"
+        int categoryId = database.categoryId(categoryColumn >= 0 ? fields.value(categoryColumn) : QString());
+        if (categoryId < 0) {
+            ++skipped;
+            continue;
+        }
+
+        importedTransactions.append(Transaction(type, amount,
+                                                descriptionColumn >= 0 ? fields.value(descriptionColumn) : QString(),
+                                                categoryId, datetime));
+    }
+
+    return true;
+}
+
+QDateTime TransactionImporter::parseOfxDate(const QString& text)
+{
+    // OFX dates look like 20240115120000.000[-5:EST]; the zone is ignored
+    QString digits = text.left(14);
+    if (digits.size() == 8)
+        return QDateTime(QDate::fromString(digits, "yyyyMMdd"), QTime(0, 0));
+    return QDateTime::fromString(digits, "yyyyMMddhhmmss");
+}
+
+bool TransactionImporter::readOfx(QTextStream& in)
+{
+    QString content = in.readAll();
+    // Statements carry no categories of their own
+    int otherCategory = database.categoryId("Other");
+
+    // OFX 1.x is SGML and often leaves elements unclosed, so each value runs
+    // up to the next tag or line break
+    static const QRegularExpression recordPattern("<STMTTRN>(.*?)</STMTTRN>",
+                                                  QRegularExpression::DotMatchesEverythingOption
+                                                  | QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression fieldPattern("<(\\w+)>([^<\\r\\n]*)");
+
+    QRegularExpressionMatchIterator records = recordPattern.globalMatch(content);
+    if (!records.hasNext()) {
+        error = "No transactions found in the OFX file.";
+        return false;
+    }
+
+    while (records.hasNext()) {
+        QString record = records.next().captured(1);
+
+        QString amountText, dateText, name, memo;
+        QRegularExpressionMatchIterator fieldIt = fieldPattern.globalMatch(record);
+        while (fieldIt.hasNext()) {
+            QRegularExpressionMatch field = fieldIt.next();
+            QString tag = field.captured(1).toUpper();
+            QString value = field.captured(2).trimmed();
+            if (tag == "TRNAMT")
+                amountText = value;
+            else if (tag == "DTPOSTED")
+                dateText = value;
+            else if (tag == "NAME")
+                name = value;
+            else if (tag == "MEMO")
+                memo = value;
+        }
+
+        bool ok = false;
+        Money amount = parseAmount(amountText, &ok);
+        QDateTime datetime = parseOfxDate(dateText);
+        if (!ok || !datetime.isValid()) {
+            ++skipped;
+            continue;
+        }
+
+        Transaction::Type type = amount.isNegative() ? Transaction::Expense : Transaction::Income;
+        importedTransactions.append(Transaction(type, amount, name.isEmpty() ? memo : name,
+                                                otherCategory, datetime));
+    }
+
+    return true;
+}
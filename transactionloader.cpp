@@ -0,0 +1,102 @@
+#include "transactionloader.h"
+#include "databasemanager.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+
+TransactionLoader::TransactionLoader(ConnectionPool *connections, QObject *parent)
+    : QObject(parent)
+    , connections(connections)
+    , latestGeneration(0)
+{
+    qRegisterMetaType<QVector<Transaction>>("QVector<Transaction>");
+}
+
+TransactionLoader::~TransactionLoader()
+{
+    // Runs on the loader thread, which owns the reader connection
+    db = QSqlDatabase();
+    connections->releaseReader();
+}
+
+void TransactionLoader::cancelBefore(quint64 generation)
+{
+    latestGeneration.store(generation);
+}
+
+bool TransactionLoader::isCancelled(quint64 generation) const
+{
+    return generation != latestGeneration.load(std::memory_order_relaxed);
+}
+
+bool TransactionLoader::openConnection()
+{
+    if (db.isOpen())
+        return true;
+
+    // Asked for here so the connection belongs to the loader thread
+    db = connections->reader();
+    if (!db.isOpen()) {
+        qDebug() << "Error opening loader connection:" << db.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+void TransactionLoader::load(quint64 generation)
+{
+    if (isCancelled(generation) || !openConnection())
+        return;
+
+    QSqlQuery firstQuery(db);
+    firstQuery.setForwardOnly(true);
+    firstQuery.prepare("SELECT * FROM transactions ORDER BY datetime_ms DESC, id DESC LIMIT :limit");
+
+    // Continue strictly after the last (datetime, id) pair already delivered
+    QSqlQuery nextQuery(db);
+    nextQuery.setForwardOnly(true);
+    nextQuery.prepare("SELECT * FROM transactions WHERE (datetime_ms, id) < (:datetime, :id) "
+                      "ORDER BY datetime_ms DESC, id DESC LIMIT :limit");
+
+    qint64 lastDatetime = 0;
+    qint64 lastId = 0;
+    int chunkSize = FirstChunkSize;
+    bool firstChunk = true;
+
+    forever {
+        QSqlQuery& query = firstChunk ? firstQuery : nextQuery;
+        if (!firstChunk) {
+            query.bindValue(":datetime", lastDatetime);
+            query.bindValue(":id", lastId);
+        }
+        query.bindValue(":limit", chunkSize);
+
+        if (!query.exec()) {
+            qDebug() << "Error loading transactions:" << query.lastError().text();
+            return;
+        }
+
+        QVector<Transaction> chunk;
+        chunk.reserve(chunkSize);
+        while (query.next()) {
+            chunk.append(DatabaseManager::transactionFromQuery(query));
+            lastDatetime = query.value("datetime_ms").toLongLong();
+            lastId = query.value("id").toLongLong();
+        }
+        query.finish();
+
+        if (isCancelled(generation))
+            return;
+
+        if (!chunk.isEmpty()) {
+            emit transactionsLoaded(generation, chunk);
+        }
+        if (chunk.size() < chunkSize)
+            break;
+
+        firstChunk = false;
+        chunkSize = ChunkSize;
+    }
+
+    emit loadingFinished(generation);
+}
@@ -0,0 +1,134 @@
+#include "transactionstore.h"
+
+void TransactionStore::clear()
+{
+    ids.clear();
+    timestampColumn.clear();
+    centsColumn.clear();
+    typeColumn.clear();
+    categoryColumn.clear();
+    descriptionStart.clear();
+    descriptionLength.clear();
+    descriptionArena.clear();
+}
+
+void TransactionStore::reserve(int count)
+{
+    ids.reserve(count);
+    timestampColumn.reserve(count);
+    centsColumn.reserve(count);
+    typeColumn.reserve(count);
+    categoryColumn.reserve(count);
+    descriptionStart.reserve(count);
+    descriptionLength.reserve(count);
+}
+
+quint32 TransactionStore::storeDescription(const QString& text)
+{
+    quint32 start = quint32(descriptionArena.size());
+    descriptionArena.append(text);
+    return start;
+}
+
+void TransactionStore::append(const Transaction& transaction)
+{
+    QString text = transaction.description();
+    ids.append(transaction.id());
+    timestampColumn.append(transaction.datetime().toMSecsSinceEpoch());
+    centsColumn.append(transaction.amount().cents());
+    typeColumn.append(quint8(transaction.type()));
+    categoryColumn.append(transaction.categoryId());
+    descriptionStart.append(storeDescription(text));
+    descriptionLength.append(quint32(text.size()));
+}
+
+void TransactionStore::append(const QVector<Transaction>& transactions)
+{
+    reserve(size() + transactions.size());
+    for (const Transaction& transaction : transactions) {
+        append(transaction);
+    }
+}
+
+void TransactionStore::replace(int row, const Transaction& transaction)
+{
+    ids[row] = transaction.id();
+    timestampColumn[row] = transaction.datetime().toMSecsSinceEpoch();
+    centsColumn[row] = transaction.amount().cents();
+    typeColumn[row] = quint8(transaction.type());
+    categoryColumn[row] = transaction.categoryId();
+
+    // Category edits leave the description alone, so the arena only grows
+    // when the text really changed
+    QString text = transaction.description();
+    if (description(row) != text) {
+        descriptionStart[row] = storeDescription(text);
+        descriptionLength[row] = quint32(text.size());
+        compactDescriptions();
+    }
+}
+
+void TransactionStore::remove(int row)
+{
+    ids.remove(row);
+    timestampColumn.remove(row);
+    centsColumn.remove(row);
+    typeColumn.remove(row);
+    categoryColumn.remove(row);
+    descriptionStart.remove(row);
+    descriptionLength.remove(row);
+}
+
+void TransactionStore::move(int from, int to)
+{
+    ids[to] = ids.at(from);
+    timestampColumn[to] = timestampColumn.at(from);
+    centsColumn[to] = centsColumn.at(from);
+    typeColumn[to] = typeColumn.at(from);
+    categoryColumn[to] = categoryColumn.at(from);
+    descriptionStart[to] = descriptionStart.at(from);
+    descriptionLength[to] = descriptionLength.at(from);
+}
+
+void TransactionStore::truncate(int count)
+{
+    ids.resize(count);
+    timestampColumn.resize(count);
+    centsColumn.resize(count);
+    typeColumn.resize(count);
+    categoryColumn.resize(count);
+    descriptionStart.resize(count);
+    descriptionLength.resize(count);
+    compactDescriptions();
+}
+
+void TransactionStore::compactDescriptions()
+{
+    // Removed and replaced rows leave dead text behind; rewrite the arena
+    // once more than half of it is unreferenced
+    qint64 live = 0;
+    for (quint32 length : descriptionLength)
+        live += length;
+    if (live * 2 >= descriptionArena.size())
+        return;
+
+    QString arena;
+    arena.reserve(live);
+    for (int row = 0; row < descriptionStart.size(); ++row) {
+        quint32 start = quint32(arena.size());
+        arena.append(description(row));
+        descriptionStart[row] = start;
+    }
+    descriptionArena = arena;
+}
+
+QStringView TransactionStore::description(int row) const
+{
+    return QStringView(descriptionArena).mid(descriptionStart.at(row), descriptionLength.at(row));
+}
+
+Transaction TransactionStore::at(int row) const
+{
+    return Transaction(type(row), Money::fromCents(centsColumn.at(row)), description(row).toString(),
+                       categoryColumn.at(row), QDateTime::fromMSecsSinceEpoch(timestampColumn.at(row)), ids.at(row));
+}
@@ -0,0 +1,116 @@
+#include "transactiontablemodel.h"
+#include <QBrush>
+
+TransactionTableModel::TransactionTableModel(const TransactionStore *transactions, QObject *parent)
+    : QAbstractTableModel(parent)
+    , transactions(transactions)
+{
+}
+
+int TransactionTableModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() || !transactions)
+        return 0;
+    return transactions->size();
+}
+
+int TransactionTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant TransactionTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount())
+        return QVariant();
+
+    int row = index.row();
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case TypeColumn:
+            return transactions->type(row) == Transaction::Income ? QStringLiteral("Income") : QStringLiteral("Expense");
+        case AmountColumn:
+            return Money::fromCents(transactions->cents(row)).abs().toString();
+        case DescriptionColumn:
+            return transactions->description(row).toString();
+        case CategoryColumn:
+            return transactions->category(row);
+        case DateTimeColumn:
+            return QDateTime::fromMSecsSinceEpoch(transactions->timestamp(row)).toString("yyyy-MM-dd hh:mm");
+        }
+    } else if (role == Qt::ForegroundRole && index.column() == TypeColumn) {
+        return QBrush(transactions->type(row) == Transaction::Income ? Qt::darkGreen : Qt::red);
+    } else if (role == Qt::TextAlignmentRole && index.column() == AmountColumn) {
+        return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+    }
+
+    return QVariant();
+}
+
+QVariant TransactionTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QAbstractTableModel::headerData(section, orientation, role);
+
+    switch (section) {
+    case TypeColumn:        return QStringLiteral("Type");
+    case AmountColumn:      return QStringLiteral("Amount");
+    case DescriptionColumn: return QStringLiteral("Description");
+    case CategoryColumn:    return QStringLiteral("Category");
+    case DateTimeColumn:    return QStringLiteral("Date/Time");
+    }
+    return QVariant();
+}
+
+Transaction TransactionTableModel::transactionAt(int row) const
+{
+    return transactions->at(row);
+}
+
+void TransactionTableModel::setTransactions(const TransactionStore *newTransactions)
+{
+    transactions = newTransactions;
+}
+
+void TransactionTableModel::refresh()
+{
+    beginResetModel();
+    endResetModel();
+}
+
+void TransactionTableModel::beginAppendTransactions(int count)
+{
+    int first = rowCount();
+    beginInsertRows(QModelIndex(), first, first + count - 1);
+}
+
+void TransactionTableModel::endAppendTransactions()
+{
+    endInsertRows();
+}
+
+void TransactionTableModel::beginRemoveTransaction(int row)
+{
+    beginRemoveRows(QModelIndex(), row, row);
+}
+
+void TransactionTableModel::endRemoveTransaction()
+{
+    endRemoveRows();
+}
+
+void TransactionTableModel::beginResetTransactions()
+{
+    beginResetModel();
+}
+
+void TransactionTableModel::endResetTransactions()
+{
+    endResetModel();
+}
+
+void TransactionTableModel::rowsChanged(int first, int last)
+{
+    emit dataChanged(index(first, 0), index(last, ColumnCount - 1));
+}
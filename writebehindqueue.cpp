@@ -0,0 +1,325 @@
+#include "writebehindqueue.h"
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSqlError>
+#include <QSqlQuery>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static const QString insertSql =
+    "INSERT INTO transactions (id, type, amount_cents, description, category_id, datetime_ms, month_key) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?)";
+// A replayed insert may already have been committed before the crash
+static const QString replayInsertSql =
+    "INSERT OR IGNORE INTO transactions (id, type, amount_cents, description, category_id, datetime_ms, month_key) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?)";
+static const QString deleteSql = "DELETE FROM transactions WHERE id = ?";
+
+// QFile::flush() only hands the data to the OS; this waits for the disk
+static bool syncToDisk(QFile& file)
+{
+    if (!file.flush())
+        return false;
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return fsync(file.handle()) == 0;
+#endif
+}
+
+WriteBehindQueue::WriteBehindQueue(ConnectionPool *connections, const QString& journalPath, QObject *parent)
+    : QObject(parent)
+    , connections(connections)
+    , journal(journalPath)
+    , commitTimer(new QTimer(this))
+    , syncTimer(new QTimer(this))
+    , nextId(1)
+{
+    qRegisterMetaType<QVector<Transaction>>("QVector<Transaction>");
+
+    commitTimer->setSingleShot(true);
+    commitTimer->setInterval(CommitIntervalMs);
+    connect(commitTimer, &QTimer::timeout, this, &WriteBehindQueue::commitPending);
+
+    // Fires once the changes already queued to this thread are journaled,
+    // so a burst costs one sync
+    syncTimer->setSingleShot(true);
+    syncTimer->setInterval(0);
+    connect(syncTimer, &QTimer::timeout, this, &WriteBehindQueue::syncJournal);
+}
+
+WriteBehindQueue::~WriteBehindQueue()
+{
+    // Runs on the queue thread, which owns the connection
+    commitPending();
+    journal.close();
+    statements.logStatistics("Write-behind queue");
+    statements.clear();
+    db = QSqlDatabase();
+    connections->releaseBackgroundWriter();
+}
+
+int WriteBehindQueue::recover()
+{
+    int replayed = 0;
+    QMetaObject::invokeMethod(this, [this, &replayed]() {
+        if (!openConnection())
+            return;
+        if (!journal.open(QIODevice::ReadWrite)) {
+            qDebug() << "Error opening write journal:" << journal.errorString();
+            updateNextId();
+            return;
+        }
+
+        QVector<Operation> operations;
+        while (!journal.atEnd()) {
+            QByteArray line = journal.readLine().trimmed();
+            Operation operation;
+            if (line.isEmpty())
+                continue;
+            if (decode(line, &operation))
+                operations.append(operation);
+            else
+                qDebug() << "Skipping unreadable journal entry:" << line.left(80);
+        }
+
+        QString error;
+        if (apply(operations, true, &error)) {
+            replayed = operations.size();
+            clearJournal();
+        } else {
+            // Set aside rather than lost; this run starts a fresh journal
+            QString path = journal.fileName();
+            qDebug() << "Error replaying write journal:" << error << "- keeping it as" << path + ".failed";
+            journal.close();
+            QFile::remove(path + ".failed");
+            QFile::rename(path, path + ".failed");
+            if (!journal.open(QIODevice::ReadWrite | QIODevice::Truncate))
+                qDebug() << "Error opening write journal:" << journal.errorString();
+        }
+        updateNextId();
+    }, Qt::BlockingQueuedConnection);
+    return replayed;
+}
+
+qint64 WriteBehindQueue::reserveId()
+{
+    return nextId.fetch_add(1);
+}
+
+void WriteBehindQueue::insert(const Transaction& transaction)
+{
+    QVector<Operation> operations{{true, transaction}};
+    QMetaObject::invokeMethod(this, [this, operations]() {
+        enqueue(operations);
+    }, Qt::QueuedConnection);
+}
+
+void WriteBehindQueue::remove(const QVector<Transaction>& transactions)
+{
+    QVector<Operation> operations;
+    operations.reserve(transactions.size());
+    for (const Transaction& transaction : transactions)
+        operations.append({false, transaction});
+    QMetaObject::invokeMethod(this, [this, operations]() {
+        enqueue(operations);
+    }, Qt::QueuedConnection);
+}
+
+void WriteBehindQueue::flush()
+{
+    // Rows written around the queue since the last flush, such as an
+    // import, moved the id sequence on; later reservations start past them
+    QMetaObject::invokeMethod(this, [this]() {
+        commitPending();
+        updateNextId();
+    }, Qt::BlockingQueuedConnection);
+}
+
+bool WriteBehindQueue::openConnection()
+{
+    if (db.isOpen())
+        return true;
+
+    db = connections->backgroundWriter();
+    if (!db.isOpen()) {
+        qDebug() << "Error opening write-behind connection:" << db.lastError().text();
+        return false;
+    }
+    statements.setDatabase(db);
+    return true;
+}
+
+void WriteBehindQueue::enqueue(const QVector<Operation>& operations)
+{
+    if (journal.isOpen()) {
+        for (const Operation& operation : operations)
+            journal.write(encode(operation) + '\n');
+        if (!syncTimer->isActive())
+            syncTimer->start();
+    }
+
+    pending += operations;
+    if (pending.size() >= CommitRows)
+        commitPending();
+    else if (!commitTimer->isActive())
+        commitTimer->start();
+}
+
+void WriteBehindQueue::syncJournal()
+{
+    if (journal.isOpen() && !syncToDisk(journal))
+        qDebug() << "Error syncing write journal:" << journal.errorString();
+}
+
+void WriteBehindQueue::commitPending()
+{
+    commitTimer->stop();
+    if (pending.isEmpty())
+        return;
+
+    QVector<Operation> operations;
+    operations.swap(pending);
+
+    QString error;
+    if (!openConnection()) {
+        error = db.lastError().text();
+    } else if (apply(operations, false, &error)) {
+        clearJournal();
+        return;
+    } else {
+        // Find the changes that fail on their own; the rest still commit
+        QVector<Operation> failed;
+        for (const Operation& operation : operations) {
+            QString operationError;
+            if (!apply({operation}, false, &operationError))
+                failed.append(operation);
+        }
+        operations = failed;
+    }
+
+    // Reported to the model, so the journal must not replay them later
+    clearJournal();
+    if (operations.isEmpty())
+        return;
+
+    QVector<Transaction> inserted;
+    QVector<Transaction> removed;
+    for (const Operation& operation : operations)
+        (operation.insert ? inserted : removed).append(operation.transaction);
+    qDebug() << "Write-behind commit failed for" << operations.size() << "changes:" << error;
+    emit writesFailed(inserted, removed, error);
+}
+
+bool WriteBehindQueue::apply(const QVector<Operation>& operations, bool replay, QString *error)
+{
+    if (operations.isEmpty())
+        return true;
+
+    if (!db.transaction()) {
+        *error = db.lastError().text();
+        return false;
+    }
+
+    for (const Operation& operation : operations) {
+        const Transaction& transaction = operation.transaction;
+        QSqlQuery *query = statements.prepare(operation.insert ? (replay ? replayInsertSql : insertSql)
+                                                               : deleteSql);
+        bool ok = query != nullptr;
+        if (ok && operation.insert) {
+            query->bindValue(0, transaction.id());
+            query->bindValue(1, int(transaction.type()));
+            query->bindValue(2, transaction.amount().cents());
+            query->bindValue(3, transaction.description());
+            query->bindValue(4, transaction.categoryId());
+            query->bindValue(5, transaction.datetime().toMSecsSinceEpoch());
+            query->bindValue(6, transaction.monthKey());
+        } else if (ok) {
+            query->bindValue(0, transaction.id());
+        }
+
+        if (!ok || !query->exec()) {
+            *error = query ? query->lastError().text() : QString("Could not prepare the statement");
+            db.rollback();
+            return false;
+        }
+    }
+
+    if (!db.commit()) {
+        *error = db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+void WriteBehindQueue::clearJournal()
+{
+    if (!journal.isOpen())
+        return;
+    syncTimer->stop();
+    if (!journal.resize(0) || !journal.seek(0) || !syncToDisk(journal))
+        qDebug() << "Error clearing write journal:" << journal.errorString();
+}
+
+void WriteBehindQueue::updateNextId()
+{
+    if (!openConnection())
+        return;
+
+    // Explicit ids move sqlite_sequence on as well, so its value covers
+    // every row this queue and the rest of the application have written
+    QSqlQuery *query = statements.prepare(
+        "SELECT MAX(COALESCE((SELECT seq FROM sqlite_sequence WHERE name = 'transactions'), 0), "
+        "COALESCE((SELECT MAX(id) FROM transactions), 0))");
+    if (!query || !query->exec() || !query->next())
+        return;
+
+    qint64 used = query->value(0).toLongLong();
+    query->finish();
+    if (nextId.load() <= used)
+        nextId.store(used + 1);
+}
+
+QByteArray WriteBehindQueue::encode(const Operation& operation)
+{
+    const Transaction& transaction = operation.transaction;
+    QJsonObject entry;
+    entry["op"] = operation.insert ? "insert" : "delete";
+    entry["id"] = transaction.id();
+    entry["type"] = int(transaction.type());
+    entry["cents"] = transaction.amount().cents();
+    entry["description"] = transaction.description();
+    entry["category"] = transaction.categoryId();
+    entry["time"] = transaction.datetime().toMSecsSinceEpoch();
+    return QJsonDocument(entry).toJson(QJsonDocument::Compact);
+}
+
+bool WriteBehindQueue::decode(const QByteArray& line, Operation *operation)
+{
+    // A crash in the middle of an append leaves a torn last line
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(line, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !document.isObject())
+        return false;
+
+    QJsonObject entry = document.object();
+    QString op = entry.value("op").toString();
+    if ((op != "insert" && op != "delete") || !entry.contains("id"))
+        return false;
+
+    operation->insert = op == "insert";
+    operation->transaction = Transaction(
+        static_cast<Transaction::Type>(entry.value("type").toInt()),
+        Money::fromCents(entry.value("cents").toInteger()),
+        entry.value("description").toString(),
+        entry.value("category").toInt(),
+        QDateTime::fromMSecsSinceEpoch(entry.value("time").toInteger()),
+        entry.value("id").toInteger());
+    return true;
+}
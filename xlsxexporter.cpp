@@ -0,0 +1,324 @@
+#include "xlsxexporter.h"
+#include <QDate>
+#include <QDateTime>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlError>
+
+namespace {
+
+const char *const SpreadsheetNamespace = "http://schemas.openxmlformats.org/spreadsheetml/2006/main";
+const char *const RelationshipNamespace = "http://schemas.openxmlformats.org/officeDocument/2006/relationships";
+
+// Cell styles, indexes into cellXfs in styles.xml
+const char *const DateStyle = "1";
+const char *const AmountStyle = "2";
+const char *const HeaderStyle = "3";
+
+// Excel counts days from 1899-12-30
+const qint64 ExcelEpochJulianDay = QDate(1899, 12, 30).toJulianDay();
+
+}
+
+XlsxExporter::XlsxExporter(ConnectionPool *connections, const QString& fileName,
+                           const TransactionFilter& filter, bool useFullTextSearch,
+                           Grouping grouping, QObject *parent)
+    : ExportWorker(connections, parent)
+    , fileName(fileName)
+    , filter(filter)
+    , useFullTextSearch(useFullTextSearch)
+    , grouping(grouping)
+{
+}
+
+void XlsxExporter::appendEscaped(QByteArray& buffer, QStringView text)
+{
+    qsizetype start = 0;
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        char16_t c = text[i].unicode();
+        const char *replacement = nullptr;
+        if (c == u'&') {
+            replacement = "&amp;";
+        } else if (c == u'<') {
+            replacement = "&lt;";
+        } else if (c == u'>') {
+            replacement = "&gt;";
+        } else if (c == u'"') {
+            replacement = "&quot;";
+        } else if (c < 0x20 && c != u'\t' && c != u'\n' && c != u'\r') {
+            replacement = "";  // Not allowed in XML 1.0
+        }
+        if (replacement) {
+            buffer.append(text.mid(start, i - start).toUtf8());
+            buffer.append(replacement);
+            start = i + 1;
+        }
+    }
+    buffer.append(text.mid(start).toUtf8());
+}
+
+void XlsxExporter::appendInlineString(QByteArray& buffer, QStringView text)
+{
+    buffer.append("<c t=\"inlineStr\"><is><t xml:space=\"preserve\">");
+    appendEscaped(buffer, text);
+    buffer.append("</t></is></c>");
+}
+
+QString XlsxExporter::uniqueSheetName(const QString& group) const
+{
+    // Sheet names are at most 31 characters and may not contain []:*?/\ .
+    QString base = group.trimmed();
+    for (QChar& c : base) {
+        if (QStringView(u"[]:*?/\\").contains(c))
+            c = u'_';
+    }
+    while (base.startsWith(u'\''))
+        base.remove(0, 1);
+    if (base.isEmpty())
+        base = "Uncategorized";
+
+    QString name = base.left(31);
+    for (int n = 2; sheetNames.contains(name, Qt::CaseInsensitive); ++n) {
+        QString suffix = QString(" (%1)").arg(n);
+        name = base.left(31 - suffix.size()) + suffix;
+    }
+    return name;
+}
+
+bool XlsxExporter::flush(ZipStreamWriter& zip)
+{
+    if (!zip.write(buffer))
+        return false;
+    buffer.resize(0);  // Keeps the allocation, unlike clear()
+    return true;
+}
+
+bool XlsxExporter::beginSheet(ZipStreamWriter& zip, const QString& group)
+{
+    sheetNames.append(uniqueSheetName(group));
+    sheetRows = 0;
+    if (!zip.beginEntry(QString("xl/worksheets/sheet%1.xml").arg(sheetNames.size())))
+        return false;
+
+    buffer.append("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n<worksheet xmlns=\"");
+    buffer.append(SpreadsheetNamespace);
+    buffer.append("\"><sheetViews><sheetView workbookViewId=\"0\">"
+                  "<pane ySplit=\"1\" topLeftCell=\"A2\" activePane=\"bottomLeft\" state=\"frozen\"/>"
+                  "</sheetView></sheetViews>"
+                  "<cols><col min=\"1\" max=\"1\" width=\"18\" customWidth=\"1\"/>"
+                  "<col min=\"2\" max=\"3\" width=\"12\" customWidth=\"1\"/>"
+                  "<col min=\"4\" max=\"4\" width=\"48\" customWidth=\"1\"/>"
+                  "<col min=\"5\" max=\"5\" width=\"20\" customWidth=\"1\"/></cols><sheetData>");
+
+    buffer.append("<row>");
+    for (const char *title : {"Date", "Type", "Amount", "Description", "Category"}) {
+        buffer.append("<c t=\"inlineStr\" s=\"");
+        buffer.append(HeaderStyle);
+        buffer.append("\"><is><t>");
+        buffer.append(title);
+        buffer.append("</t></is></c>");
+    }
+    buffer.append("</row>");
+    return true;
+}
+
+bool XlsxExporter::endSheet(ZipStreamWriter& zip)
+{
+    buffer.append("</sheetData></worksheet>");
+    return flush(zip) && zip.endEntry();
+}
+
+bool XlsxExporter::writeEntry(ZipStreamWriter& zip, const QString& name, const QByteArray& data)
+{
+    return zip.beginEntry(name) && zip.write(data) && zip.endEntry();
+}
+
+bool XlsxExporter::writeWorkbookParts(ZipStreamWriter& zip)
+{
+    const QByteArray header = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n";
+
+    QByteArray contentTypes = header;
+    contentTypes.append("<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">"
+                        "<Default Extension=\"rels\" ContentType=\"application/vnd.openxmlformats-package.relationships+xml\"/>"
+                        "<Default Extension=\"xml\" ContentType=\"application/xml\"/>"
+                        "<Override PartName=\"/xl/workbook.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.sheet.main+xml\"/>"
+                        "<Override PartName=\"/xl/styles.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.styles+xml\"/>");
+    for (int i = 1; i <= sheetNames.size(); ++i) {
+        contentTypes.append("<Override PartName=\"/xl/worksheets/sheet" + QByteArray::number(i)
+                            + ".xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.worksheet+xml\"/>");
+    }
+    contentTypes.append("</Types>");
+
+    QByteArray rootRels = header;
+    rootRels.append("<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+                    "<Relationship Id=\"rId1\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/officeDocument\" Target=\"xl/workbook.xml\"/>"
+                    "</Relationships>");
+
+    QByteArray workbook = header;
+    workbook.append(QByteArray("<workbook xmlns=\"") + SpreadsheetNamespace
+                    + "\" xmlns:r=\"" + RelationshipNamespace + "\"><sheets>");
+    for (int i = 0; i < sheetNames.size(); ++i) {
+        workbook.append("<sheet name=\"");
+        appendEscaped(workbook, sheetNames[i]);
+        workbook.append("\" sheetId=\"" + QByteArray::number(i + 1) + "\" r:id=\"rId" + QByteArray::number(i + 1) + "\"/>");
+    }
+    workbook.append("</sheets></workbook>");
+
+    QByteArray workbookRels = header;
+    workbookRels.append("<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">");
+    for (int i = 1; i <= sheetNames.size(); ++i) {
+        workbookRels.append("<Relationship Id=\"rId" + QByteArray::number(i)
+                            + "\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/worksheet\" Target=\"worksheets/sheet"
+                            + QByteArray::number(i) + ".xml\"/>");
+    }
+    workbookRels.append("<Relationship Id=\"rId" + QByteArray::number(sheetNames.size() + 1)
+                        + "\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/styles\" Target=\"styles.xml\"/>"
+                        "</Relationships>");
+
+    QByteArray styles = header;
+    styles.append(QByteArray("<styleSheet xmlns=\"") + SpreadsheetNamespace + "\">"
+                  "<numFmts count=\"2\"><numFmt numFmtId=\"164\" formatCode=\"yyyy-mm-dd hh:mm\"/>"
+                  "<numFmt numFmtId=\"165\" formatCode=\"#,##0.00\"/></numFmts>"
+                  "<fonts count=\"2\"><font><sz val=\"11\"/><name val=\"Calibri\"/></font>"
+                  "<font><b/><sz val=\"11\"/><name val=\"Calibri\"/></font></fonts>"
+                  "<fills count=\"2\"><fill><patternFill patternType=\"none\"/></fill>"
+                  "<fill><patternFill patternType=\"gray125\"/></fill></fills>"
+                  "<borders count=\"1\"><border><left/><right/><top/><bottom/><diagonal/></border></borders>"
+                  "<cellStyleXfs count=\"1\"><xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" borderId=\"0\"/></cellStyleXfs>"
+                  "<cellXfs count=\"4\"><xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" borderId=\"0\" xfId=\"0\"/>"
+                  "<xf numFmtId=\"164\" fontId=\"0\" fillId=\"0\" borderId=\"0\" xfId=\"0\" applyNumberFormat=\"1\"/>"
+                  "<xf numFmtId=\"165\" fontId=\"0\" fillId=\"0\" borderId=\"0\" xfId=\"0\" applyNumberFormat=\"1\"/>"
+                  "<xf numFmtId=\"0\" fontId=\"1\" fillId=\"0\" borderId=\"0\" xfId=\"0\" applyFont=\"1\"/></cellXfs>"
+                  "<cellStyles count=\"1\"><cellStyle name=\"Normal\" xfId=\"0\" builtinId=\"0\"/></cellStyles>"
+                  "</styleSheet>");
+
+    return writeEntry(zip, "[Content_Types].xml", contentTypes)
+        && writeEntry(zip, "_rels/.rels", rootRels)
+        && writeEntry(zip, "xl/workbook.xml", workbook)
+        && writeEntry(zip, "xl/_rels/workbook.xml.rels", workbookRels)
+        && writeEntry(zip, "xl/styles.xml", styles);
+}
+
+bool XlsxExporter::exportData(QSqlDatabase& db, QString *message, QString *error)
+{
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    // Rows arrive grouped, so each sheet is written start to finish in turn.
+    // The order is always explicit: a search would otherwise sort by rank.
+    QString sortOrder = grouping == ByCategory ? "t.category_id, t.datetime_ms DESC" : "t.datetime_ms DESC";
+    if (!DatabaseManager::prepareFilterQuery(query, filter, useFullTextSearch, sortOrder) || !query.exec()) {
+        *error = "Could not read transactions: " + query.lastError().text();
+        return false;
+    }
+
+    QSqlRecord record = query.record();
+    int datetimeColumn = record.indexOf("datetime_ms");
+    int typeColumn = record.indexOf("type");
+    int amountColumn = record.indexOf("amount_cents");
+    int descriptionColumn = record.indexOf("description");
+    int categoryColumn = record.indexOf("category");
+    int categoryIdColumn = record.indexOf("category_id");
+
+    ZipStreamWriter zip(fileName);
+    if (!zip.open()) {
+        *error = "Could not open file for writing.";
+        return false;
+    }
+
+    sheetNames.clear();
+    buffer.resize(0);
+    buffer.reserve(BufferSize + 4096);
+
+    bool ok = true;
+    bool cancelled = false;
+    bool sheetOpen = false;
+    int currentCategoryId = -1;
+    int currentMonthKey = -1;
+    int rows = 0;
+    while (ok && query.next()) {
+        // Stored as epoch milliseconds; sheets and cells use local time
+        QDateTime datetime = QDateTime::fromMSecsSinceEpoch(query.value(datetimeColumn).toLongLong());
+        QDate date = datetime.date();
+        QString category = query.value(categoryColumn).toString();
+
+        // Category sheets change on the integer id; month sheets on year * 12 + month
+        int categoryId = query.value(categoryIdColumn).toInt();
+        int monthKey = date.year() * 12 + date.month() - 1;
+        bool newGroup = grouping == ByCategory ? categoryId != currentCategoryId : monthKey != currentMonthKey;
+        if (!sheetOpen || newGroup || sheetRows == MaxRowsPerSheet) {
+            QString group = grouping == ByCategory ? category : date.toString("yyyy-MM");
+            if (sheetOpen && !endSheet(zip)) {
+                ok = false;
+                break;
+            }
+            // A full sheet continues as "<group> (2)" and so on
+            if (!beginSheet(zip, group)) {
+                ok = false;
+                break;
+            }
+            sheetOpen = true;
+            currentCategoryId = categoryId;
+            currentMonthKey = monthKey;
+        }
+
+        buffer.append("<row>");
+
+        if (date.isValid()) {
+            int seconds = datetime.time().msecsSinceStartOfDay() / 1000;
+            double serial = double(date.toJulianDay() - ExcelEpochJulianDay) + seconds / 86400.0;
+            buffer.append("<c s=\"");
+            buffer.append(DateStyle);
+            buffer.append("\"><v>");
+            buffer.append(QByteArray::number(serial, 'f', 6));
+            buffer.append("</v></c>");
+        } else {
+            appendInlineString(buffer, datetime.toString(Qt::ISODate));
+        }
+
+        appendInlineString(buffer, query.value(typeColumn).toInt() == Transaction::Income ? u"Income" : u"Expense");
+
+        buffer.append("<c s=\"");
+        buffer.append(AmountStyle);
+        buffer.append("\"><v>");
+        buffer.append(Money::fromCents(query.value(amountColumn).toLongLong()).abs().toString().toLatin1());
+        buffer.append("</v></c>");
+
+        appendInlineString(buffer, query.value(descriptionColumn).toString());
+        appendInlineString(buffer, category);
+        buffer.append("</row>");
+        ++sheetRows;
+
+        if (buffer.size() >= BufferSize && !flush(zip)) {
+            ok = false;
+            break;
+        }
+
+        if (++rows % ProgressInterval == 0) {
+            if (isCancelled()) {
+                cancelled = true;
+                break;
+            }
+            reportProgress(rows);
+        }
+    }
+
+    if (ok && !cancelled) {
+        // A workbook needs at least one sheet, even when nothing matched
+        if (!sheetOpen) {
+            ok = beginSheet(zip, "Transactions");
+        }
+        ok = ok && endSheet(zip) && writeWorkbookParts(zip) && zip.close();
+    }
+
+    if (!ok || cancelled) {
+        if (!ok) {
+            *error = "Could not write to file: " + zip.errorString();
+        }
+        zip.discard();
+        return false;
+    }
+
+    reportProgress(rows);
+    *message = QString("%1 transactions exported to %2 sheets.").arg(rows).arg(sheetNames.size());
+    return true;
+}
@@ -0,0 +1,242 @@
+#include "zipstreamwriter.h"
+#include <QDateTime>
+
+// Largest size or offset a ZIP field holds without ZIP64 records
+static const qint64 zip32Limit = 0xffffffffLL;
+
+ZipStreamWriter::ZipStreamWriter(const QString& fileName)
+    : file(fileName)
+{
+    // All entries are stamped with the creation time in DOS format
+    QDateTime now = QDateTime::currentDateTime();
+    dosTime = quint16((now.time().hour() << 11) | (now.time().minute() << 5) | (now.time().second() / 2));
+    dosDate = quint16(((now.date().year() - 1980) << 9) | (now.date().month() << 5) | now.date().day());
+}
+
+ZipStreamWriter::~ZipStreamWriter()
+{
+#ifdef HAVE_ZLIB
+    if (inEntry) {
+        deflateEnd(&stream);
+    }
+#endif
+}
+
+bool ZipStreamWriter::open()
+{
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+void ZipStreamWriter::appendLE16(QByteArray& out, quint16 value)
+{
+    out.append(char(value & 0xff));
+    out.append(char(value >> 8));
+}
+
+void ZipStreamWriter::appendLE32(QByteArray& out, quint32 value)
+{
+    appendLE16(out, quint16(value & 0xffff));
+    appendLE16(out, quint16(value >> 16));
+}
+
+quint32 ZipStreamWriter::updateCrc(quint32 crc, const char *data, qint64 size)
+{
+    static quint32 table[256];
+    static const bool tableReady = [] {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        return true;
+    }();
+    Q_UNUSED(tableReady);
+
+    crc = ~crc;
+    for (qint64 i = 0; i < size; ++i)
+        crc = table[(crc ^ quint8(data[i])) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+bool ZipStreamWriter::writeRaw(const char *data, qint64 size)
+{
+    if (file.write(data, size) != size) {
+        error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool ZipStreamWriter::fitsZip32(qint64 value)
+{
+    if (value <= zip32Limit)
+        return true;
+    error = "The archive would be larger than the 4 GB a ZIP file without ZIP64 can hold.";
+    return false;
+}
+
+bool ZipStreamWriter::beginEntry(const QString& name)
+{
+    if (entries.size() >= 0xffff) {
+        error = "The archive would have more entries than a ZIP file without ZIP64 can hold.";
+        return false;
+    }
+    current = Entry();
+    current.name = name.toUtf8();
+    current.offset = file.pos();
+    if (!fitsZip32(current.offset))
+        return false;
+#ifdef HAVE_ZLIB
+    current.method = 8;  // Deflate
+    stream = z_stream();
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        error = "Could not initialize compression.";
+        return false;
+    }
+    deflateBuffer.resize(1 << 16);
+#else
+    current.method = 0;  // Stored
+#endif
+    inEntry = true;
+
+    // Local header; CRC and sizes follow in the data descriptor (flag bit 3),
+    // and bit 11 marks the name as UTF-8
+    QByteArray header;
+    appendLE32(header, 0x04034b50);
+    appendLE16(header, 20);
+    appendLE16(header, 0x0808);
+    appendLE16(header, current.method);
+    appendLE16(header, dosTime);
+    appendLE16(header, dosDate);
+    appendLE32(header, 0);
+    appendLE32(header, 0);
+    appendLE32(header, 0);
+    appendLE16(header, quint16(current.name.size()));
+    appendLE16(header, 0);
+    header.append(current.name);
+    return writeRaw(header.constData(), header.size());
+}
+
+bool ZipStreamWriter::write(const QByteArray& data)
+{
+    current.crc = updateCrc(current.crc, data.constData(), data.size());
+    current.uncompressedSize += data.size();
+    if (!fitsZip32(current.uncompressedSize))
+        return false;
+
+#ifdef HAVE_ZLIB
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in = uInt(data.size());
+    do {
+        stream.next_out = reinterpret_cast<Bytef *>(deflateBuffer.data());
+        stream.avail_out = uInt(deflateBuffer.size());
+        deflate(&stream, Z_NO_FLUSH);
+        qint64 produced = deflateBuffer.size() - stream.avail_out;
+        current.compressedSize += produced;
+        if (!fitsZip32(current.compressedSize)
+            || (produced > 0 && !writeRaw(deflateBuffer.constData(), produced)))
+            return false;
+    } while (stream.avail_out == 0);
+    return true;
+#else
+    current.compressedSize += data.size();
+    if (!fitsZip32(current.compressedSize))
+        return false;
+    return writeRaw(data.constData(), data.size());
+#endif
+}
+
+bool ZipStreamWriter::endEntry()
+{
+#ifdef HAVE_ZLIB
+    int result;
+    stream.next_in = nullptr;
+    stream.avail_in = 0;
+    do {
+        stream.next_out = reinterpret_cast<Bytef *>(deflateBuffer.data());
+        stream.avail_out = uInt(deflateBuffer.size());
+        result = deflate(&stream, Z_FINISH);
+        qint64 produced = deflateBuffer.size() - stream.avail_out;
+        current.compressedSize += produced;
+        if (!fitsZip32(current.compressedSize)
+            || (produced > 0 && !writeRaw(deflateBuffer.constData(), produced))) {
+            deflateEnd(&stream);
+            inEntry = false;
+            return false;
+        }
+    } while (result != Z_STREAM_END);
+    deflateEnd(&stream);
+#endif
+    inEntry = false;
+
+    QByteArray descriptor;
+    appendLE32(descriptor, 0x08074b50);
+    appendLE32(descriptor, current.crc);
+    appendLE32(descriptor, quint32(current.compressedSize));
+    appendLE32(descriptor, quint32(current.uncompressedSize));
+    entries.append(current);
+    return writeRaw(descriptor.constData(), descriptor.size());
+}
+
+bool ZipStreamWriter::close()
+{
+    qint64 directoryOffset = file.pos();
+    if (!fitsZip32(directoryOffset))
+        return false;
+
+    QByteArray directory;
+    for (const Entry& entry : entries) {
+        appendLE32(directory, 0x02014b50);
+        appendLE16(directory, 20);
+        appendLE16(directory, 20);
+        appendLE16(directory, 0x0808);
+        appendLE16(directory, entry.method);
+        appendLE16(directory, dosTime);
+        appendLE16(directory, dosDate);
+        appendLE32(directory, entry.crc);
+        appendLE32(directory, quint32(entry.compressedSize));
+        appendLE32(directory, quint32(entry.uncompressedSize));
+        appendLE16(directory, quint16(entry.name.size()));
+        appendLE16(directory, 0);
+        appendLE16(directory, 0);
+        appendLE16(directory, 0);
+        appendLE16(directory, 0);
+        appendLE32(directory, 0);
+        appendLE32(directory, quint32(entry.offset));
+        directory.append(entry.name);
+    }
+    qint64 directorySize = directory.size();
+    if (!fitsZip32(directoryOffset + directorySize))
+        return false;
+
+    appendLE32(directory, 0x06054b50);
+    appendLE16(directory, 0);
+    appendLE16(directory, 0);
+    appendLE16(directory, quint16(entries.size()));
+    appendLE16(directory, quint16(entries.size()));
+    appendLE32(directory, quint32(directorySize));
+    appendLE32(directory, quint32(directoryOffset));
+    appendLE16(directory, 0);
+
+    if (!writeRaw(directory.constData(), directory.size()))
+        return false;
+    file.close();
+    return true;
+}
+
+void ZipStreamWriter::discard()
+{
+#ifdef HAVE_ZLIB
+    if (inEntry) {
+        deflateEnd(&stream);
+        inEntry = false;
+    }
+#endif
+    file.close();
+    file.remove();
+}